@@ -0,0 +1,135 @@
+#if defined(ARDUINO_M5Stick_C)
+ #include <AXP192.h>
+#endif
+
+#include <LovyanGFX.hpp>
+
+static LGFX lcd;
+static LGFX_Sprite canvas(&lcd);
+
+// float arc rasterizer used before the fixed-point version. kept here as the benchmark reference.
+static void legacy_fill_arc(LGFX_Sprite* dst, int32_t cx, int32_t cy, int32_t oradius, int32_t iradius, float start, float end)
+{
+  static constexpr float deg_to_rad = 0.017453292519943295769236907684886;
+  if (oradius < iradius) std::swap(oradius, iradius);
+  start = fmodf(start, 360);
+  end = fmodf(end, 360);
+  if (start < 0) start += 360.0;
+  if (end < 0) end += 360.0;
+
+  float s_cos = (cos(start * deg_to_rad));
+  float e_cos = (cos(end * deg_to_rad));
+  float sslope = s_cos / (sin(start * deg_to_rad));
+  float eslope = -1000000;
+  if (end != 360.0) eslope = e_cos / (sin(end * deg_to_rad));
+  float swidth =  0.5 / s_cos;
+  float ewidth = -0.5 / e_cos;
+  --iradius;
+  int ir2 = iradius * iradius + iradius;
+  int or2 = oradius * oradius + oradius;
+
+  bool start180 = !(start < 180);
+  bool end180 = end < 180;
+  bool reversed = start + 180 < end || (end < start && start < end + 180);
+
+  int xs = -oradius;
+  int y = -oradius;
+  int ye = oradius;
+  int xe = oradius + 1;
+  if (!reversed) {
+    if (   (end >= 270 || end < 90) && (start >= 270 || start < 90)) xs = 0;
+    else if (end < 270 && end >= 90 && start < 270 && start >= 90) xe = 1;
+    if (     end >= 180 && start >= 180) ye = 0;
+    else if (end < 180 && start < 180) y = 0;
+  }
+  do {
+    int y2 = y * y;
+    int x = xs;
+    if (x < 0) {
+      while (x * x + y2 >= or2) ++x;
+      if (xe != 1) xe = 1 - x;
+    }
+    float ysslope = (y + swidth) * sslope;
+    float yeslope = (y + ewidth) * eslope;
+    int len = 0;
+    do {
+      bool flg1 = start180 != (x <= ysslope);
+      bool flg2 =   end180 != (x <= yeslope);
+      int distance = x * x + y2;
+      if (distance >= ir2
+       && ((flg1 && flg2) || (reversed && (flg1 || flg2)))
+       && x != xe
+       && distance < or2
+        ) {
+        ++len;
+      } else {
+        if (len) {
+          dst->drawFastHLine(cx + x - len, cy + y, len);
+          len = 0;
+        }
+        if (distance >= or2) break;
+        if (x < 0 && distance < ir2) { x = -x; }
+      }
+    } while (++x <= xe);
+  } while (++y <= ye);
+}
+
+// one frame of a radial gauge panel : 12 gauges with a track and a value arc each.
+static void draw_gauges(bool legacy, int frame)
+{
+  canvas.fillScreen(TFT_BLACK);
+  canvas.startWrite();
+  for (int i = 0; i < 12; ++i) {
+    int cx = 40 + (i % 4) * 80;
+    int cy = 40 + (i / 4) * 80;
+    float value = 135 + ((frame * 7 + i * 23) % 270);
+    if (legacy) {
+      canvas.setColor(TFT_DARKGREY);
+      legacy_fill_arc(&canvas, cx, cy, 36, 28, 135, 45);
+      canvas.setColor(TFT_GREEN);
+      legacy_fill_arc(&canvas, cx, cy, 36, 28, 135, value);
+    } else {
+      canvas.fillArc(cx, cy, 36, 28, 135, 45, TFT_DARKGREY);
+      canvas.fillArc(cx, cy, 36, 28, 135, value, TFT_GREEN);
+    }
+  }
+  canvas.endWrite();
+}
+
+static uint32_t bench(bool legacy)
+{
+  uint32_t t = micros();
+  for (int frame = 0; frame < 50; ++frame) {
+    draw_gauges(legacy, frame);
+  }
+  return (micros() - t) / 50;
+}
+
+void setup(void)
+{
+#if defined(ARDUINO_M5Stick_C)
+  AXP192 axp;
+  axp.begin();
+#endif
+  Serial.begin(115200);
+
+  lcd.init();
+  lcd.setRotation(1);
+
+  canvas.setColorDepth(16);
+  canvas.createSprite(320, 240);
+}
+
+void loop(void)
+{
+  uint32_t usec_legacy = bench(true);
+  uint32_t usec_fixed  = bench(false);
+
+  Serial.printf("fillArc per frame  float : %6u us   fixed : %6u us\n", usec_legacy, usec_fixed);
+
+  canvas.setCursor(0, 0);
+  canvas.setTextColor(TFT_WHITE, TFT_BLACK);
+  canvas.printf("float %6u us\nfixed %6u us", usec_legacy, usec_fixed);
+  canvas.pushSprite(0, 0);
+  delay(1000);
+}
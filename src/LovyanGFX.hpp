@@ -41,6 +41,11 @@ Contributors:
 #include "lgfx/LGFXBase.hpp"           // base class (always include)
 
 #include "lgfx/LGFX_Sprite.hpp"         // sprite class (optional)
+#include "lgfx/LGFX_TiledSprite.hpp"    // sparse tiled sprite class (optional)
+#include "lgfx/LGFX_TileViewport.hpp"   // tiled image file viewport (optional)
+#include "lgfx/LGFX_DisplayList.hpp"    // display list recorder (optional)
+#include "lgfx/LGFX_BandRenderer.hpp"   // banded display list renderer (optional)
+#include "lgfx/LGFX_Framebuffer.hpp"    // RAM framebuffer display device (optional)
 
 #include "lgfx/panel/Panel_HX8357.hpp"
 #include "lgfx/panel/Panel_ILI9163.hpp"
@@ -51,6 +56,10 @@ Contributors:
 #include "lgfx/panel/Panel_ST7789.hpp"    // LilyGO TTGO T-Watch
 #include "lgfx/panel/Panel_ST7735.hpp"    // M5StickC
 
+#include "lgfx/LGFX_Device.hpp"         // panel protocol on a bus interface (optional)
+#include "lgfx/bus/Bus_Memory.hpp"      // memory bus for the host build (optional)
+#include "lgfx/bus/Bus_VirtualPanel.hpp" // emulated panel for the host build (optional)
+
 
 #if defined (ESP32) || (CONFIG_IDF_TARGET_ESP32)
 
@@ -94,6 +103,10 @@ Contributors:
 #elif defined( LGFX_WIO_TERMINAL ) || defined (ARDUINO_WIO_TERMINAL) || defined(WIO_TERMINAL)
   #include "config/LGFX_Config_WioTerminal.hpp"
 
+#elif defined ( LGFX_HOST )
+
+  // host build : no board config. use LGFX_Framebuffer, or LGFX_Device with Bus_VirtualPanel.
+
 #else
 
   // If none of the above apply, Put a copy of "config/LGFX_Config_Custom" in libraries folder,
@@ -22,7 +22,6 @@ Contributors:
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
-#include <list>
 
 namespace lgfx
 {
@@ -39,6 +38,7 @@ namespace lgfx
 
   void LGFXBase::setClipRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
   {
+    _clip_count = 0;
     if (x < 0) { w += x; x = 0; }
     if (w > _width - x)  w = _width  - x;
     if (w < 1) { x = 0; w = 0; }
@@ -62,12 +62,107 @@ namespace lgfx
 
   void LGFXBase::clearClipRect(void)
   {
+    _clip_count = 0;
     _clip_l = 0;
     _clip_r = _width - 1;
     _clip_t = 0;
     _clip_b = _height - 1;
   }
 
+  bool LGFXBase::setClipRegion(const rect_t* rects, std::uint32_t count)
+  {
+    static constexpr std::uint32_t FRAG_MAX = 32;
+    clip_rect_t frag[2][FRAG_MAX];
+    clip_rect_t* region = _clip_rects;
+    std::uint32_t n = 0;
+    bool fit = true;
+    std::int32_t bl = INT32_MAX, br = INT32_MIN, bt = INT32_MAX, bb = INT32_MIN;
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::int32_t x = rects[i].x, w = rects[i].w;
+      std::int32_t y = rects[i].y, h = rects[i].h;
+      _adjust_abs(x, w);
+      _adjust_abs(y, h);
+      std::int32_t l = std::max<std::int32_t>(x, 0), r = std::min<std::int32_t>(x + w, _width ) - 1;
+      std::int32_t t = std::max<std::int32_t>(y, 0), b = std::min<std::int32_t>(y + h, _height) - 1;
+      if (l > r || t > b) continue;
+      if (bl > l) bl = l;
+      if (br < r) br = r;
+      if (bt > t) bt = t;
+      if (bb < b) bb = b;
+      if (!fit) continue;
+
+      // cut away the pieces already in the region
+      std::uint32_t fn = 1, cur = 0;
+      frag[0][0] = { (std::int16_t)l, (std::int16_t)t, (std::int16_t)r, (std::int16_t)b };
+      for (std::uint32_t j = 0; j < n && fn && fit; ++j) {
+        auto& e = region[j];
+        auto src = frag[cur];
+        auto dst = frag[cur ^ 1];
+        std::uint32_t dn = 0;
+        for (std::uint32_t k = 0; k < fn; ++k) {
+          auto f = src[k];
+          if (f.r < e.l || f.l > e.r || f.b < e.t || f.t > e.b) {
+            if (dn == FRAG_MAX) { fit = false; break; }
+            dst[dn++] = f;
+            continue;
+          }
+          if (dn + 4 > FRAG_MAX) { fit = false; break; }
+          std::int16_t mt = std::max(f.t, e.t), mb = std::min(f.b, e.b);
+          if (f.t < e.t) dst[dn++] = { f.l, f.t, f.r, (std::int16_t)(e.t - 1) };
+          if (f.b > e.b) dst[dn++] = { f.l, (std::int16_t)(e.b + 1), f.r, f.b };
+          if (f.l < e.l) dst[dn++] = { f.l, mt, (std::int16_t)(e.l - 1), mb };
+          if (f.r > e.r) dst[dn++] = { (std::int16_t)(e.r + 1), mt, f.r, mb };
+        }
+        fn = dn;
+        cur ^= 1;
+      }
+      if (n + fn > CLIP_REGION_MAX) fit = false;
+      if (!fit) continue;
+      memcpy(&region[n], frag[cur], fn * sizeof(clip_rect_t));
+      n += fn;
+    }
+
+    if (bl > br) { setClipRect(0, 0, 0, 0); return true; }
+    setClipRect(bl, bt, br - bl + 1, bb - bt + 1);
+    if (fit && n > 1) _clip_count = n;
+    return fit;
+  }
+
+  std::uint32_t LGFXBase::getClipRegion(rect_t* rects) const
+  {
+    for (std::uint32_t i = 0; i < _clip_count; ++i) {
+      auto& c = _clip_rects[i];
+      rects[i] = { c.l, c.t, c.r - c.l + 1, c.b - c.t + 1 };
+    }
+    return _clip_count;
+  }
+
+  void LGFXBase::fill_span_region(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+  {
+    std::int32_t xe = x + w - 1, ye = y + h - 1;
+    for (std::uint32_t i = 0; i < _clip_count; ++i) {
+      auto& c = _clip_rects[i];
+      std::int32_t l = std::max<std::int32_t>(x, c.l), r = std::min<std::int32_t>(xe, c.r);
+      std::int32_t t = std::max<std::int32_t>(y, c.t), b = std::min<std::int32_t>(ye, c.b);
+      if (l <= r && t <= b) put_span(l, t, r - l + 1, b - t + 1);
+    }
+  }
+
+  void LGFXBase::draw_pixels(const point_t* points, const std::uint32_t* rawcolors, std::uint32_t count)
+  {
+    if (!_clip_count) { drawPixels_impl(points, rawcolors, count); return; }
+    std::uint32_t color = _color.raw;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::int32_t x = points[i].x;
+      std::int32_t y = points[i].y;
+      if (x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b || !in_clip_region(x, y)) continue;
+      if (rawcolors) _color.raw = rawcolors[i];
+      drawPixel_impl(x, y);
+    }
+    _color.raw = color;
+  }
+
   void LGFXBase::setScrollRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
   {
     _adjust_abs(x, w);
@@ -112,6 +207,7 @@ namespace lgfx
 
   void LGFXBase::writeFastVLine(std::int32_t x, std::int32_t y, std::int32_t h)
   {
+    if (_span_record) _span_cache->record(x - _span_ox, y - _span_oy, 1, h);
     if (x < _clip_l || x > _clip_r) return;
     auto ct = _clip_t;
     if (y < ct) { h += y - ct; y = ct; }
@@ -119,7 +215,7 @@ namespace lgfx
     if (h > cb) h = cb;
     if (h < 1) return;
 
-    writeFillRect_impl(x, y, 1, h);
+    fill_span(x, y, 1, h);
   }
 
   void LGFXBase::drawFastHLine(std::int32_t x, std::int32_t y, std::int32_t w)
@@ -133,6 +229,7 @@ namespace lgfx
 
   void LGFXBase::writeFastHLine(std::int32_t x, std::int32_t y, std::int32_t w)
   {
+    if (_span_record) _span_cache->record(x - _span_ox, y - _span_oy, w, 1);
     if (y < _clip_t || y > _clip_b) return;
     auto cl = _clip_l;
     if (x < cl) { w += x - cl; x = cl; }
@@ -140,7 +237,7 @@ namespace lgfx
     if (w > cr) w = cr;
     if (w < 1) return;
 
-    writeFillRect_impl(x, y, w, 1);
+    fill_span(x, y, w, 1);
   }
 
   void LGFXBase::fillRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
@@ -155,6 +252,7 @@ namespace lgfx
 
   void LGFXBase::writeFillRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
   {
+    if (_span_record) _span_cache->record(x - _span_ox, y - _span_oy, w, h);
     auto cl = _clip_l;
     if (x < cl) { w += x - cl; x = cl; }
     auto cr = _clip_r + 1 - x;
@@ -167,9 +265,133 @@ namespace lgfx
     if (h > cb) h = cb;
     if (h < 1) return;
 
-    writeFillRect_impl(x, y, w, h);
+    fill_span(x, y, w, h);
   }
 
+  void LGFXBase::push_span(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+  {
+    std::uint32_t color = _color.raw;
+    if (_span_count && _span_color != color) flush_spans();
+    _span_color = color;
+    for (std::uint32_t i = 0; i < _span_count; ++i) {
+      auto s = &_spans[i];
+      if (s->x == x && s->w == w) {
+        if (s->y + s->h == y) { s->h += h; return; }                    // continues downward
+        if (y + h == s->y) { s->y = y; s->h += h; return; }             // continues upward
+        if (y >= s->y && y + h <= s->y + s->h) return;                  // already covered
+      }
+      if (s->h == 1 && h == 1 && s->y == y && x <= s->x + s->w && s->x <= x + w) { // same row, overlap or adjacent
+        std::int32_t xe = std::max(s->x + s->w, x + w);
+        s->x = std::min(s->x, x);
+        s->w = xe - s->x;
+        return;
+      }
+    }
+    if (_span_count == SPAN_SLOTS) {  // write out the oldest one.
+      writeFillRect_impl(_spans[0].x, _spans[0].y, _spans[0].w, _spans[0].h);
+      memmove(_spans, &_spans[1], sizeof(span_t) * (SPAN_SLOTS - 1));
+      --_span_count;
+    }
+    _spans[_span_count++] = { x, y, w, h };
+  }
+
+  bool LGFXBase::draw_cached(const LGFX_SpanCache::key_t& key, std::int32_t x, std::int32_t y)
+  {
+    if (!_span_cache || _span_record) return false;
+    auto e = _span_cache->find(key);
+    if (!e) {
+      _span_cache->begin_record(key);
+      _span_record = true;
+      _span_ox = x;
+      _span_oy = y;
+      return false;
+    }
+    if (x + e->r < _clip_l || x + e->l > _clip_r || y + e->b < _clip_t || y + e->t > _clip_b) return true;
+    auto s = e->spans;
+    for (std::uint32_t i = e->count; i; --i, ++s) {
+      writeFillRect(x + s->x, y + s->y, s->w, s->h);
+    }
+    return true;
+  }
+
+  void LGFXBase::store_cached(void)
+  {
+    if (!_span_record) return;
+    _span_record = false;
+    _span_cache->end_record();
+  }
+
+  void LGFXBase::flush_spans(void)
+  {
+    std::uint32_t color = _color.raw;
+    _color.raw = _span_color;
+    for (std::uint32_t i = 0; i < _span_count; ++i) {
+      writeFillRect_impl(_spans[i].x, _spans[i].y, _spans[i].w, _spans[i].h);
+    }
+    _span_count = 0;
+    _color.raw = color;
+  }
+
+
+  void LGFXBase::drawPixels(const point_t* points, std::uint32_t count)
+  {
+    startWrite();
+    draw_pixels(points, nullptr, count);
+    endWrite();
+  }
+
+  void LGFXBase::drawPixels_impl(const point_t* points, const std::uint32_t* rawcolors, std::uint32_t count)
+  {
+    std::uint32_t color = _color.raw;
+    std::int32_t cl = _clip_l, cr = _clip_r, ct = _clip_t, cb = _clip_b;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::int32_t x = points[i].x;
+      std::int32_t y = points[i].y;
+      if (x < cl || x > cr || y < ct || y > cb) continue;
+      if (rawcolors) _color.raw = rawcolors[i];
+      drawPixel_impl(x, y);
+    }
+    _color.raw = color;
+  }
+
+  void LGFXBase::fillRects(const rect_t* rects, std::uint32_t count)
+  {
+    startWrite();
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::int32_t x = rects[i].x, w = rects[i].w;
+      std::int32_t y = rects[i].y, h = rects[i].h;
+      _adjust_abs(x, w);
+      _adjust_abs(y, h);
+      writeFillRect(x, y, w, h);
+    }
+    endWrite();
+  }
+
+  void LGFXBase::drawPolyline(const point_t* points, std::uint32_t count)
+  {
+    if (count < 2) {
+      if (count) drawPixel(points[0].x, points[0].y);
+      return;
+    }
+    startWrite();
+    begin_spans();
+    for (std::uint32_t i = 1; i < count; ++i) {
+      drawLine(points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
+    }
+    end_spans();
+    endWrite();
+  }
+
+  void LGFXBase::drawLines(const point_t* points, std::uint32_t count)
+  {
+    startWrite();
+    begin_spans();
+    for (std::uint32_t i = 0; i < count; ++i, points += 2) {
+      drawLine(points[0].x, points[0].y, points[1].x, points[1].y);
+    }
+    end_spans();
+    endWrite();
+  }
 
   void LGFXBase::drawRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
   {
@@ -261,8 +483,13 @@ namespace lgfx
 
   void LGFXBase::fillCircle(std::int32_t x, std::int32_t y, std::int32_t r) {
     startWrite();
-    writeFastHLine(x - r, y, (r << 1) + 1);
-    fillCircleHelper(x, y, r, 3, 0);
+    begin_spans();
+    if (!draw_cached({ LGFX_SpanCache::shape_circle, r, 0, 0, 0 }, x, y)) {
+      writeFastHLine(x - r, y, (r << 1) + 1);
+      fillCircleHelper(x, y, r, 3, 0);
+      store_cached();
+    }
+    end_spans();
     endWrite();
   }
 
@@ -278,6 +505,7 @@ namespace lgfx
     std::int32_t i     = 0;
 
     startWrite();
+    begin_spans();
     do {
       std::int32_t len = 0;
       while (f < 0) {
@@ -296,6 +524,7 @@ namespace lgfx
         if (len) writeFillRect(x - r, y - i, (r << 1) + delta, len);
       }
     } while (i < --r);
+    end_spans();
     endWrite();
   }
 
@@ -366,6 +595,7 @@ namespace lgfx
     std::int32_t s;
 
     startWrite();
+    begin_spans();
 
     writeFastHLine(x - rx, y, (rx << 1) + 1);
     i = 0;
@@ -390,6 +620,7 @@ namespace lgfx
       s -= (--yt) * rx2 << 2;
     } while(ry2 * xt <= rx2 * yt);
 
+    end_spans();
     endWrite();
   }
 
@@ -442,6 +673,12 @@ namespace lgfx
   {
     if (_adjust_abs(x, w)||_adjust_abs(y, h)) return; 
     startWrite();
+    begin_spans();
+    if (draw_cached({ LGFX_SpanCache::shape_round_rect, w, h, r, 0 }, x, y)) {
+      end_spans();
+      endWrite();
+      return;
+    }
     std::int32_t y2 = y + r;
     std::int32_t y1 = y + h - r - 1;
     std::int32_t ddF_y = - (r << 1);
@@ -467,6 +704,8 @@ namespace lgfx
       ddF_x += 2;
       f     += ddF_x;
     }
+    store_cached();
+    end_spans();
     endWrite();
   }
 
@@ -485,13 +724,24 @@ namespace lgfx
     std::int32_t xstart = steep ? _clip_t : _clip_l;
     std::int32_t ystart = steep ? _clip_l : _clip_t;
     std::int32_t yend   = steep ? _clip_r : _clip_b;
-    while (x0 < xstart || y0 < ystart || y0 > yend) {
-      err -= dy;
-      if (err < 0) {
-        err += dx;
-        y0 += ystep;
+    if (x0 < xstart || y0 < ystart || y0 > yend) {
+      // jump to the first step inside the clip rect.
+      // after k steps : ysteps = ceil((k * dy - err) / dx), err = err - k * dy + ysteps * dx
+      if ((ystep > 0) ? (y0 > yend) : (y0 < ystart)) return;
+      std::int64_t k = xstart - x0;
+      if (k < 0) k = 0;
+      std::int32_t t = (ystep > 0) ? ystart - y0 : y0 - yend;
+      if (t > 0) {
+        if (!dy) return;
+        std::int64_t ky = ((std::int64_t)(t - 1) * dx + err) / dy + 1;
+        if (k < ky) k = ky;
       }
-      if (++x0 > x1) return;
+      if (k > dx) return;
+      std::int32_t ysteps = (k * dy - err + dx - 1) / dx;
+      x0 += k;
+      y0 += ysteps * ystep;
+      err = err - k * dy + (std::int64_t)ysteps * dx;
+      if (y0 < ystart || y0 > yend) return;
     }
     std::int32_t xs = x0;
     std::int32_t dlen = 0;
@@ -579,6 +829,7 @@ namespace lgfx
                    ? std::min(dx2, dy2)
                    : dx2);
     startWrite();
+    begin_spans();
     if (y0 != y1) {
       do {
         err1 -= dx1;
@@ -615,9 +866,153 @@ namespace lgfx
       while (err2 < 0) { err2 += dy2; if ((b += xstep2) == x2) break; }
       writeFastHLine(a, y0, b - a + 1);
     } while (++y0 <= y2);
+    end_spans();
     endWrite();
   }
 
+  struct polygon_edge_t
+  {
+    std::int32_t q;   // (x - 0.5) in pixels at the centre of the current scanline : q + r / den
+    std::int32_t r;
+    std::int32_t den;
+    std::int32_t sq;  // step per scanline : sq + sr / den
+    std::int32_t sr;
+    std::int32_t y0;  // first scanline
+    std::int32_t y1;  // last scanline + 1
+    std::int32_t dir; // winding direction
+
+    // first pixel whose centre is at or right of x
+    std::int32_t pixel(void) const { return q + (r > 0); }
+    bool operator<(const polygon_edge_t& rhs) const { return q < rhs.q || (q == rhs.q && (std::int64_t)r * rhs.den < (std::int64_t)rhs.r * den); }
+  };
+
+  static std::int64_t floor_div64(std::int64_t n, std::int64_t d) { std::int64_t q = n / d; return (q * d != n && ((n < 0) != (d < 0))) ? q - 1 : q; }
+
+  void LGFXBase::fillPolygon(const point_t* points, std::uint32_t count, fill_rule_t rule)
+  {
+    fill_polygon(points, &count, 1, rule, 0);
+  }
+
+  void LGFXBase::fill_polygon(const point_t* points, const std::uint32_t* counts, std::uint32_t contours, fill_rule_t rule, std::uint32_t shift)
+  {
+    std::uint32_t total = 0;
+    for (std::uint32_t c = 0; c < contours; ++c) total += counts[c];
+    if (total < 3) return;
+
+    std::int32_t cl = _clip_l, cr = _clip_r + 1;
+    std::int32_t ct = _clip_t, cb = _clip_b + 1;
+    std::int32_t xmin = points[0].x, xmax = xmin;
+    for (std::uint32_t i = 1; i < total; ++i) {
+      if (xmin > points[i].x) xmin = points[i].x;
+      if (xmax < points[i].x) xmax = points[i].x;
+    }
+    if ((xmax >> shift) < cl || (xmin >> shift) >= cr) return;
+
+    auto edges = (polygon_edge_t*)heap_alloc(total * (sizeof(polygon_edge_t) + sizeof(polygon_edge_t*)));
+    if (!edges) return;
+    auto active = (polygon_edge_t**)&edges[total];
+
+// build the edge table. horizontal edges and edges outside the clip rows are dropped.
+// coordinates are fixed point with `shift` fraction bits, pixel centres sit at +0.5.
+// x is stepped exactly as an integer and a remainder, so edges shared by two polygons
+// produce the same pixels on both sides.
+    std::int64_t s = 1 << shift;
+    std::uint32_t ecount = 0;
+    std::int32_t yend = ct;
+    for (std::uint32_t c = 0; c < contours; ++c) {
+      std::uint32_t n = counts[c];
+      for (std::uint32_t i = 0; i < n; ++i) {
+        std::int64_t x0 = points[i].x;
+        std::int64_t y0 = points[i].y;
+        std::int64_t x1 = points[(i + 1 == n) ? 0 : i + 1].x;
+        std::int64_t y1 = points[(i + 1 == n) ? 0 : i + 1].y;
+        if (y0 == y1) continue;
+        std::int32_t dir = 1;
+        if (y0 > y1) { std::swap(x0, x1); std::swap(y0, y1); dir = -1; }
+
+        // scanlines whose centre lies in [y0, y1)
+        std::int32_t ys = -floor_div64(s - 2 * y0, 2 * s);
+        std::int32_t ye = -floor_div64(s - 2 * y1, 2 * s);
+        if (ye <= ct || ys >= cb || ys >= ye) continue;
+
+        auto e = &edges[ecount++];
+        e->y0 = ys < ct ? ct : ys;
+        e->y1 = ye < cb ? ye : cb;
+        e->dir = dir;
+
+        // (x - 0.5) in pixels = num / den
+        std::int64_t dx = x1 - x0;
+        std::int64_t dy = y1 - y0;
+        std::int64_t den = 2 * dy * s;
+        std::int64_t num = 2 * dy * x0 - dy * s + dx * (2 * e->y0 * s + s - 2 * y0);
+        std::int64_t q = floor_div64(num, den);
+        e->den = den;
+        e->q = q;
+        e->r = num - q * den;
+        q = floor_div64(2 * dx * s, den);
+        e->sq = q;
+        e->sr = 2 * dx * s - q * den;
+        if (yend < e->y1) yend = e->y1;
+      }
+      points += n;
+    }
+    if (ecount) {
+      std::sort(edges, edges + ecount, [](const polygon_edge_t& a, const polygon_edge_t& b) { return a.y0 < b.y0; });
+
+      startWrite();
+      begin_spans();
+      std::uint32_t next = 0;
+      std::uint32_t acount = 0;
+      for (std::int32_t y = edges[0].y0; y < yend; ++y) {
+        std::uint32_t j = 0;
+        for (std::uint32_t i = 0; i < acount; ++i) {
+          if (active[i]->y1 > y) active[j++] = active[i];
+        }
+        acount = j;
+        while (next < ecount && edges[next].y0 == y) active[acount++] = &edges[next++];
+        if (!acount) {
+          if (next == ecount) break;
+          y = edges[next].y0 - 1;
+          continue;
+        }
+
+// the active edges stay nearly sorted between scanlines.
+        for (std::uint32_t i = 1; i < acount; ++i) {
+          auto e = active[i];
+          j = i;
+          for (; j && *e < *active[j - 1]; --j) active[j] = active[j - 1];
+          active[j] = e;
+        }
+
+        std::int32_t wind = 0;
+        std::int32_t xs = 0;
+        for (std::uint32_t i = 0; i < acount; ++i) {
+          bool inside = (rule == non_zero) ? (wind != 0) : (wind & 1);
+          wind += (rule == non_zero) ? active[i]->dir : 1;
+          if (inside == ((rule == non_zero) ? (wind != 0) : (wind & 1))) continue;
+          if (!inside) {
+            xs = active[i]->pixel();
+            continue;
+          }
+          std::int32_t l = xs < cl ? cl : xs;
+          std::int32_t r = active[i]->pixel();
+          if (r > cr) r = cr;
+          if (l < r) writeFillRectPreclipped(l, y, r - l, 1);
+        }
+
+        for (std::uint32_t i = 0; i < acount; ++i) {
+          auto e = active[i];
+          e->q += e->sq;
+          e->r += e->sr;
+          if (e->r >= e->den) { e->r -= e->den; ++e->q; }
+        }
+      }
+      end_spans();
+      endWrite();
+    }
+    heap_free(edges);
+  }
+
   void LGFXBase::drawBezier( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2)
   {
     std::int32_t x = x0 - x1, y = y0 - y1;
@@ -746,24 +1141,326 @@ namespace lgfx
     endWrite();
   }
 
+  struct LGFXBase::gradient_t
+  {
+    std::int32_t ox, oy;             // affine : origin of the planes. radial : centre
+    std::int32_t v[3], dx[3], dy[3]; // r,g,b in 16.16 at the origin and the step per pixel. radial : dx is the step per unit of t
+    std::int32_t lo[3], hi[3];       // clamp range of the affine planes
+    float inv_r = 0.0f;              // radial : 1 / radius. 0 : affine
+
+    static std::int32_t channel(std::uint32_t rgb888, std::int32_t i) { return (rgb888 >> (16 - (i << 3))) & 0xFF; }
+    static std::int32_t limit_step(std::int64_t d) { return d < -(1 << 23) ? -(1 << 23) : d > (1 << 23) ? (1 << 23) : d; }
+
+    gradient_t(const linear_gradient_t& g) { set_linear(g.x0, g.y0, g.x1, g.y1, g.color0, g.color1); }
+
+    gradient_t(const radial_gradient_t& g) : ox(g.x), oy(g.y), inv_r(g.r > 0 ? 1.0f / g.r : 65536.0f)
+    {
+      for (std::int32_t i = 0; i < 3; ++i) {
+        std::int32_t c0 = channel(g.color0, i);
+        v[i] = (c0 << 16) + 0x8000;
+        dx[i] = channel(g.color1, i) - c0;
+      }
+    }
+
+    gradient_t(std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, std::uint32_t rgb0, std::uint32_t rgb1, std::uint32_t rgb2)
+    {
+      std::int64_t det = (std::int64_t)(x1 - x0) * (y2 - y0) - (std::int64_t)(x2 - x0) * (y1 - y0);
+      if (!det) { // degenerate : shade along the longest side.
+        std::int32_t d01 = abs(x1 - x0) + abs(y1 - y0);
+        std::int32_t d02 = abs(x2 - x0) + abs(y2 - y0);
+        std::int32_t d12 = abs(x2 - x1) + abs(y2 - y1);
+        if (d01 >= d02 && d01 >= d12) set_linear(x0, y0, x1, y1, rgb0, rgb1);
+        else if (d02 >= d12)          set_linear(x0, y0, x2, y2, rgb0, rgb2);
+        else                          set_linear(x1, y1, x2, y2, rgb1, rgb2);
+        return;
+      }
+      ox = x0;
+      oy = y0;
+      for (std::int32_t i = 0; i < 3; ++i) {
+        std::int32_t c0 = channel(rgb0, i);
+        std::int32_t c1 = channel(rgb1, i);
+        std::int32_t c2 = channel(rgb2, i);
+        std::int64_t e1 = c1 - c0;
+        std::int64_t e2 = c2 - c0;
+        v[i] = (c0 << 16) + 0x8000;
+        dx[i] = limit_step(((e1 * (y2 - y0) - e2 * (y1 - y0)) << 16) / det);
+        dy[i] = limit_step(((e2 * (x1 - x0) - e1 * (x2 - x0)) << 16) / det);
+        lo[i] =  std::min(c0, std::min(c1, c2)) << 16;
+        hi[i] = (std::max(c0, std::max(c1, c2)) << 16) | 0xFFFF;
+      }
+    }
+
+    void set_linear(std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::uint32_t rgb0, std::uint32_t rgb1)
+    {
+      ox = x0;
+      oy = y0;
+      std::int64_t gx = x1 - x0;
+      std::int64_t gy = y1 - y0;
+      std::int64_t len2 = gx * gx + gy * gy;
+      for (std::int32_t i = 0; i < 3; ++i) {
+        std::int32_t c0 = channel(rgb0, i);
+        std::int32_t c1 = channel(rgb1, i);
+        std::int64_t dc = (std::int64_t)(c1 - c0) << 16;
+        v[i] = (c0 << 16) + 0x8000;
+        dx[i] = len2 ? limit_step(dc * gx / len2) : 0;
+        dy[i] = len2 ? limit_step(dc * gy / len2) : 0;
+        lo[i] =  std::min(c0, c1) << 16;
+        hi[i] = (std::max(c0, c1) << 16) | 0xFFFF;
+      }
+    }
+  };
+
+  void LGFXBase::gradient_row(bgr888_t* buf, std::int32_t x, std::int32_t y, std::int32_t len) const
+  {
+    auto g = _gradient;
+    std::int32_t c[3], d[3];
+    if (g->inv_r == 0.0f) {
+      // pixels [k0, k1) need no clamping on any channel.
+      std::int32_t k0 = 0, k1 = len;
+      for (std::int32_t i = 0; i < 3; ++i) {
+        std::int64_t s = g->v[i] + (std::int64_t)g->dx[i] * (x - g->ox) + (std::int64_t)g->dy[i] * (y - g->oy);
+        // far outside of the range : every pixel of the row is clamped anyway. (len <= 64, |dx| <= 1<<23)
+        std::int64_t l = g->lo[i] - (1 << 29);
+        std::int64_t h = g->hi[i] + (1 << 29);
+        c[i] = s < l ? l : s > h ? h : s;
+        d[i] = g->dx[i];
+        std::int32_t lo = g->lo[i] - c[i];
+        std::int32_t hi = g->hi[i] - c[i];
+        if (d[i] > 0) {
+          if (lo > 0) k0 = std::max(k0, (lo + d[i] - 1) / d[i]);
+          k1 = std::min(k1, hi < 0 ? 0 : hi / d[i] + 1);
+        } else if (d[i] < 0) {
+          if (hi < 0) k0 = std::max(k0, (hi + d[i] + 1) / d[i]);
+          k1 = std::min(k1, lo > 0 ? 0 : lo / d[i] + 1);
+        } else if (lo > 0 || hi < 0) {
+          k1 = 0;
+        }
+      }
+      if (k1 < k0) k1 = k0;
+      std::int32_t r = c[0], gr = c[1], b = c[2];
+      std::int32_t dr = d[0], dg = d[1], db = d[2];
+      for (std::int32_t k = 0; k < len; ++k) {
+        if (k == k0) {  // unclamped run
+          for (; k < k1; ++k) {
+            buf[k].set(r >> 16, gr >> 16, b >> 16);
+            r += dr; gr += dg; b += db;
+          }
+          if (k == len) break;
+        }
+        buf[k].set( (r  < g->lo[0] ? g->lo[0] : r  > g->hi[0] ? g->hi[0] : r ) >> 16
+                  , (gr < g->lo[1] ? g->lo[1] : gr > g->hi[1] ? g->hi[1] : gr) >> 16
+                  , (b  < g->lo[2] ? g->lo[2] : b  > g->hi[2] ? g->hi[2] : b ) >> 16);
+        r += dr; gr += dg; b += db;
+      }
+      return;
+    }
+
+    // radial : t = distance / radius in 16.16, exact at the segment ends and stepped linearly between.
+    // the segments break at the centre column and get shorter where the distance curves more. (t error < 1/512)
+    float fy = y - g->oy;
+    float fy2 = fy * fy;
+    float inv_r = g->inv_r * 65536.0f;
+    float seg = 1.0f / (inv_r * g->inv_r * 64.0f);  // n * n <= t * seg
+    auto radius_t = [&](std::int32_t px) -> std::int32_t
+    {
+      float fx = px - g->ox;
+      float t = sqrtf(fx * fx + fy2) * inv_r;
+      return t < 16777216.0f ? (std::int32_t)t : 16777216;
+    };
+    std::int32_t dr = g->dx[0], dg = g->dx[1], db = g->dx[2];
+    std::int32_t t0 = radius_t(x);
+    std::int32_t k = 0;
+    while (k < len) {
+      std::int32_t n = len - k;
+      if (n > 16) n = 16;
+      float lim = t0 * seg;
+      while (n > 1 && n * n > lim) n >>= 1;
+      std::int32_t px = x + k;
+      if (px < g->ox && px + n > g->ox) n = g->ox - px;
+      std::int32_t t1 = radius_t(px + n);
+      std::int32_t st = (t1 - t0) / n;
+      std::int32_t t = t0;
+      do {
+        std::int32_t tc = t < 0x10000 ? t : 0x10000;
+        buf[k++].set((g->v[0] + dr * tc) >> 16, (g->v[1] + dg * tc) >> 16, (g->v[2] + db * tc) >> 16);
+        t += st;
+      } while (--n);
+      t0 = t1;
+    }
+  }
+
+  void LGFXBase::gradient_fill(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+  {
+    auto g = _gradient;
+    bool affine = (g->inv_r == 0.0f);
+    bool flat_x = affine && !(g->dx[0] | g->dx[1] | g->dx[2]);
+    bool flat_y = affine && !(g->dy[0] | g->dy[1] | g->dy[2]);
+    std::int32_t rows = flat_y ? h : 1;  // rows sharing one colour row
+    std::uint32_t color = _color.raw;
+    bgr888_t buf[64];
+
+    if (flat_x) { // one colour per row
+      do {
+        gradient_row(buf, x, y, 1);
+        _color.raw = _write_conv.convert(color888(buf[0].r, buf[0].g, buf[0].b));
+        writeFillRect_impl(x, y, w, rows);
+        y += rows;
+      } while (h -= rows);
+    } else if (hasPalette() || _write_conv.depth < 8) {
+      // no direct colour : write the runs of the same raw colour.
+      for (std::int32_t j = 0; j < h; j += rows) {
+        for (std::int32_t i = 0; i < w; i += 64) {
+          std::int32_t len = (w - i < 64) ? w - i : 64;
+          gradient_row(buf, x + i, y + j, len);
+          std::int32_t k = 0;
+          while (k < len) {
+            std::uint32_t raw = _write_conv.convert(color888(buf[k].r, buf[k].g, buf[k].b));
+            std::int32_t e = k;
+            while (++e < len && raw == _write_conv.convert(color888(buf[e].r, buf[e].g, buf[e].b)));
+            _color.raw = raw;
+            writeFillRect_impl(x + i + k, y + j, e - k, rows);
+            k = e;
+          }
+        }
+      }
+    } else {
+      // the row is built in rgb888 and written in the destination format in one go.
+      pixelcopy_t p(buf, _write_conv.depth, rgb888_3Byte, false);
+      for (std::int32_t j = 0; j < h; j += rows) {
+        for (std::int32_t i = 0; i < w; i += 64) {
+          std::int32_t len = (w - i < 64) ? w - i : 64;
+          gradient_row(buf, x + i, y + j, len);
+          for (std::int32_t k = 0; k < rows; ++k) {
+            push_image(x + i, y + j + k, len, 1, &p);
+          }
+        }
+      }
+    }
+    _color.raw = color;
+  }
+
+  void LGFXBase::fill_gouraud_triangle(std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, std::uint32_t rgb0, std::uint32_t rgb1, std::uint32_t rgb2)
+  {
+    gradient_t g(x0, y0, x1, y1, x2, y2, rgb0, rgb1, rgb2);
+    _gradient = &g;
+    fillTriangle(x0, y0, x1, y1, x2, y2);
+    _gradient = nullptr;
+  }
+
+  void LGFXBase::fillGradientRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const linear_gradient_t& gradient)
+  {
+    gradient_t g(gradient);
+    _gradient = &g;
+    fillRect(x, y, w, h);
+    _gradient = nullptr;
+  }
+
+  void LGFXBase::fillGradientRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const radial_gradient_t& gradient)
+  {
+    gradient_t g(gradient);
+    _gradient = &g;
+    fillRect(x, y, w, h);
+    _gradient = nullptr;
+  }
+
+  void LGFXBase::fillGradientRoundRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::int32_t r, const linear_gradient_t& gradient)
+  {
+    gradient_t g(gradient);
+    _gradient = &g;
+    fillRoundRect(x, y, w, h, r);
+    _gradient = nullptr;
+  }
+
+  void LGFXBase::fillGradientRoundRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::int32_t r, const radial_gradient_t& gradient)
+  {
+    gradient_t g(gradient);
+    _gradient = &g;
+    fillRoundRect(x, y, w, h, r);
+    _gradient = nullptr;
+  }
+
+  void LGFXBase::fillGradientCircle(std::int32_t x, std::int32_t y, std::int32_t r, const linear_gradient_t& gradient)
+  {
+    gradient_t g(gradient);
+    _gradient = &g;
+    fillCircle(x, y, r);
+    _gradient = nullptr;
+  }
+
+  void LGFXBase::fillGradientCircle(std::int32_t x, std::int32_t y, std::int32_t r, const radial_gradient_t& gradient)
+  {
+    gradient_t g(gradient);
+    _gradient = &g;
+    fillCircle(x, y, r);
+    _gradient = nullptr;
+  }
+
+  // quarter wave sine table. Q15, 64 steps per 90 degrees.
+  static constexpr std::uint16_t sin_table[65] =
+  {     0,   804,  1608,  2411,  3212,  4011,  4808,  5602,  6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793
+  , 12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531, 18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595
+  , 23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791, 27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957
+  , 30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972, 32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758
+  , 32768
+  };
+
+  // angle : 0x10000 per turn. result : Q15
+  static std::int32_t sin_q15(std::uint32_t angle)
+  {
+    std::uint32_t q = angle & 0x7FFF;
+    if (q > 0x4000) q = 0x8000 - q;
+    std::uint32_t i = q >> 8;
+    std::int32_t v = sin_table[i];
+    if (i < 64) v += ((sin_table[i + 1] - v) * (std::int32_t)(q & 0xFF)) >> 8;
+    return (angle & 0x8000) ? -v : v;
+  }
+
+  static std::uint32_t degree_to_angle(float degree)
+  {
+    return (std::uint32_t)(std::int32_t)(degree * (65536.0f / 360.0f) + (degree < 0 ? -0.5f : 0.5f)) & 0xFFFF;
+  }
+
+  static std::int32_t div_floor(std::int32_t n, std::int32_t d) { std::int32_t q = n / d; return (q * d != n && ((n < 0) != (d < 0))) ? q - 1 : q; }
+  static std::int32_t div_ceil( std::int32_t n, std::int32_t d) { std::int32_t q = n / d; return (q * d != n && ((n < 0) == (d < 0))) ? q + 1 : q; }
+
+  struct arc_edge_t
+  {
+    std::int32_t a, b, c;  // inside : a * x + b * y + c >= 0
+
+    // narrow [lo, hi] to the pixels of row y inside the edge.
+    void clip(std::int32_t y, std::int32_t& lo, std::int32_t& hi) const
+    {
+      std::int32_t k = -(b * y + c);
+      if (a > 0) {
+        std::int32_t v = div_ceil(k, a);
+        if (lo < v) lo = v;
+      } else if (a < 0) {
+        std::int32_t v = div_floor(k, a);
+        if (hi > v) hi = v;
+      } else if (k > 0) {
+        lo = hi + 1;
+      }
+    }
+  };
+
   void LGFXBase::drawArc(std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float start, float end)
   {
     if (r0 < r1) std::swap(r0, r1);
     if (r0 < 1) r0 = 1;
     if (r1 < 1) r1 = 1;
 
-    bool equal = fabsf(start - end) < std::numeric_limits<float>::epsilon();
-    start = fmodf(start, 360);
-    end = fmodf(end, 360);
-    if (start < 0) start += 360.0;
-    if (end < 0) end += 360.0;
+    std::uint32_t s = degree_to_angle(start);
+    std::uint32_t e = degree_to_angle(end);
+    std::uint32_t sweep = (e - s) & 0xFFFF;
+    if (!sweep && fabsf(end - start) > 180) sweep = 0x10000;
 
     startWrite();
-    fill_arc_helper(x, y, r0, r1, start, start);
-    fill_arc_helper(x, y, r0, r1, end  , end);
-    if (!equal && (fabsf(start - end) <= 0.0001)) { start = .0; end = 360.0; }
-    fill_arc_helper(x, y, r0, r0, start, end);
-    fill_arc_helper(x, y, r1, r1, start, end);
+    begin_spans();
+    fill_arc_helper(x, y, r0, r1, s, 0);
+    fill_arc_helper(x, y, r0, r1, e, 0);
+    fill_arc_helper(x, y, r0, r0, s, sweep);
+    fill_arc_helper(x, y, r1, r1, s, sweep);
+    end_spans();
     endWrite();
   }
 
@@ -773,80 +1470,728 @@ namespace lgfx
     if (r0 < 1) r0 = 1;
     if (r1 < 1) r1 = 1;
 
-    bool equal = fabsf(start - end) < std::numeric_limits<float>::epsilon();
-    start = fmodf(start, 360);
-    end = fmodf(end, 360);
-    if (start < 0) start += 360.0;
-    if (end < 0) end += 360.0;
-    if (!equal && (fabsf(start - end) <= 0.0001)) { start = .0; end = 360.0; }
+    std::uint32_t s = degree_to_angle(start);
+    std::uint32_t sweep = (degree_to_angle(end) - s) & 0xFFFF;
+    if (!sweep && fabsf(end - start) > 180) sweep = 0x10000;
 
     startWrite();
-    fill_arc_helper(x, y, r0, r1, start, end);
+    begin_spans();
+    if (!draw_cached({ LGFX_SpanCache::shape_arc, r0, r1, (std::int32_t)s, (std::int32_t)sweep }, x, y)) {
+      fill_arc_helper(x, y, r0, r1, s, sweep);
+      store_cached();
+    }
+    end_spans();
     endWrite();
   }
 
-  void LGFXBase::fill_arc_helper(std::int32_t cx, std::int32_t cy, std::int32_t oradius, std::int32_t iradius, float start, float end)
+  void LGFXBase::fill_arc_helper(std::int32_t cx, std::int32_t cy, std::int32_t oradius, std::int32_t iradius, std::uint32_t start, std::uint32_t sweep)
   {
-    float s_cos = (cos(start * deg_to_rad));
-    float e_cos = (cos(end * deg_to_rad));
-    float sslope = s_cos / (sin(start * deg_to_rad));
-    float eslope = -1000000;
-    if (end != 360.0) eslope = e_cos / (sin(end * deg_to_rad));
-    float swidth =  0.5 / s_cos;
-    float ewidth = -0.5 / e_cos;
+    if (oradius > 0x3FFF) oradius = 0x3FFF;  // keeps the row equations within 32bit
+
+// pixels within half a pixel of the start and end rays belong to the arc.
+    std::uint32_t end = start + sweep;
+    std::uint32_t mid = start + (sweep >> 1);
+    arc_edge_t edge[3] =
+    { { -sin_q15(start), sin_q15(start + 0x4000), 1 << 14 }
+    , {  sin_q15(end  ), -sin_q15(end + 0x4000) , 1 << 14 }
+    , {  sin_q15(mid + 0x4000), sin_q15(mid)    , 1 << 14 }  // drops the opposite side of the centre
+    };
+    bool full   = sweep >= 0x10000;
+    bool reflex = sweep > 0x8000;
+
     --iradius;
-    int ir2 = iradius * iradius + iradius;
-    int or2 = oradius * oradius + oradius;
-
-    bool start180 = !(start < 180);
-    bool end180 = end < 180;
-    bool reversed = start + 180 < end || (end < start && start < end + 180);
-
-    int xs = -oradius;
-    int y = -oradius;
-    int ye = oradius;
-    int xe = oradius + 1;
-    if (!reversed) {
-      if (   (end >= 270 || end < 90) && (start >= 270 || start < 90)) xs = 0;
-      else if (end < 270 && end >= 90 && start < 270 && start >= 90) xe = 1;
-      if (     end >= 180 && start >= 180) ye = 0;
-      else if (end < 180 && start < 180) y = 0;
+    std::int32_t ir2 = iradius * iradius + iradius;
+    std::int32_t or2 = oradius * oradius + oradius;
+    std::int32_t xo = oradius;
+    std::int32_t xi = iradius ? iradius + 1 : 0;
+    std::int32_t lim = oradius + 1;
+
+    for (std::int32_t y = 0; y <= oradius; ++y) {
+      std::int32_t y2 = y * y;
+      while (xo >= 0 && xo * xo + y2 >= or2) --xo;
+      while (xi > 0 && (xi - 1) * (xi - 1) + y2 >= ir2) --xi;
+      if (xo < 0) break;
+
+      // ring segments of this row
+      std::int32_t ring[2][2] = { { -xo, xi ? -xi : xo }, { xi, xo } };
+      std::int32_t rings = (xi == 0) ? 1 : (xi <= xo) ? 2 : 0;
+
+      for (std::int32_t ry = y; ; ry = -y) {
+        // angle ranges of this row
+        std::int32_t range[2][2] = { { -lim, lim }, { -lim, lim } };
+        std::int32_t ranges = 1;
+        if (!full) {
+          edge[0].clip(ry, range[0][0], range[0][1]);
+          if (!reflex) {
+            edge[1].clip(ry, range[0][0], range[0][1]);
+            edge[2].clip(ry, range[0][0], range[0][1]);
+          } else {
+            edge[1].clip(ry, range[1][0], range[1][1]);
+            if (range[0][0] > range[1][0]) {
+              std::swap(range[0][0], range[1][0]);
+              std::swap(range[0][1], range[1][1]);
+            }
+            if (range[0][0] > range[0][1]) {
+              range[0][0] = range[1][0];
+              range[0][1] = range[1][1];
+            } else if (range[1][0] <= range[1][1]) {
+              if (range[1][0] <= range[0][1] + 1) {
+                if (range[0][1] < range[1][1]) range[0][1] = range[1][1];
+              } else {
+                ranges = 2;
+              }
+            }
+          }
+        }
+
+        for (std::int32_t i = 0; i < rings; ++i) {
+          for (std::int32_t j = 0; j < ranges; ++j) {
+            std::int32_t l = std::max(ring[i][0], range[j][0]);
+            std::int32_t r = std::min(ring[i][1], range[j][1]);
+            if (l <= r) writeFastHLine(cx + l, cy + ry, r - l + 1);
+          }
+        }
+        if (ry <= 0) break;
+      }
     }
-    do {
-      int y2 = y * y;
-      int x = xs;
-      if (x < 0) {
-        while (x * x + y2 >= or2) ++x;
-        if (xe != 1) xe = 1 - x;
+  }
+
+  // stroke outlines are collected as contours in 1/16 pixel units and filled once with the non-zero rule.
+  struct stroke_builder_t
+  {
+    static constexpr std::uint32_t shift = 4;
+    point_t* points;
+    std::uint32_t* counts;
+    std::uint32_t npoints;
+    std::uint32_t ncontours;
+    std::uint32_t start;
+
+    void add(float x, float y)
+    {
+      points[npoints++] = { (std::int32_t)floorf((x + 0.5f) * (1 << shift) + 0.5f), (std::int32_t)floorf((y + 0.5f) * (1 << shift) + 0.5f) };
+    }
+
+    // close the contour and turn it to the common winding direction.
+    void close(void)
+    {
+      std::uint32_t n = npoints - start;
+      if (n < 3) { npoints = start; return; }
+      auto p = &points[start];
+      std::int64_t area = 0;
+      for (std::uint32_t i = 0; i < n; ++i) {
+        auto& a = p[i];
+        auto& b = p[(i + 1 == n) ? 0 : i + 1];
+        area += (std::int64_t)a.x * b.y - (std::int64_t)b.x * a.y;
       }
-      float ysslope = (y + swidth) * sslope;
-      float yeslope = (y + ewidth) * eslope;
-      int len = 0;
-      do {
-        bool flg1 = start180 != (x <= ysslope);
-        bool flg2 =   end180 != (x <= yeslope);
-        int distance = x * x + y2;
-        if (distance >= ir2
-         && ((flg1 && flg2) || (reversed && (flg1 || flg2)))
-         && x != xe
-         && distance < or2
-          ) {
-          ++len;
+      if (area < 0) std::reverse(p, p + n);
+      counts[ncontours++] = n;
+      start = npoints;
+    }
+
+    void add_circle(float x, float y, float r, std::uint32_t sides)
+    {
+      for (std::uint32_t i = 0; i < sides; ++i) {
+        std::uint32_t a = (i << 16) / sides;
+        add(x + r * sin_q15(a + 0x4000) * (1.0f / 32768), y + r * sin_q15(a) * (1.0f / 32768));
+      }
+      close();
+    }
+  };
+
+  // sides of a polygon keeping the chord error of a round join or cap under 1/8 pixel.
+  static std::uint32_t stroke_round_sides(float r)
+  {
+    if (r <= 0.5f) return 8;
+    std::uint32_t n = (std::uint32_t)ceilf(3.14159265f / acosf(1.0f - 0.125f / r));
+    return (n < 8) ? 8 : (n > 64) ? 64 : n;
+  }
+
+  // points left after dropping the repeated ones.
+  template <typename TGet>
+  static std::uint32_t stroke_distinct(TGet get, std::uint32_t count)
+  {
+    std::uint32_t m = 0;
+    float px = 0, py = 0;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      float x, y;
+      get(i, x, y);
+      if (m && x == px && y == py) continue;
+      px = x; py = y; ++m;
+    }
+    return m;
+  }
+
+  // room for the stroke of a polyline of m distinct points.
+  static void stroke_room(std::uint32_t m, std::uint32_t sides, std::uint32_t& points, std::uint32_t& contours)
+  {
+    points += m * (4 + std::max(sides, 4u)) + sides * 2;
+    contours += m * 2 + 4;
+  }
+
+  static bool stroke_alloc(stroke_builder_t& sb, std::uint32_t points, std::uint32_t contours)
+  {
+    sb.points = (point_t*)heap_alloc(sizeof(point_t) * points + sizeof(std::uint32_t) * contours);
+    if (!sb.points) return false;
+    sb.counts = (std::uint32_t*)&sb.points[points];
+    sb.npoints = sb.ncontours = sb.start = 0;
+    return true;
+  }
+
+  // add the outline of a polyline of m distinct points.
+  template <typename TGet>
+  static void add_stroke(stroke_builder_t& sb, TGet get, std::uint32_t count, std::uint32_t m, float hw, std::uint32_t sides, line_cap_t cap, line_join_t join)
+  {
+    float x0 = 0, y0 = 0;  // previous point
+    float nx0 = 0, ny0 = 0, dx0 = 0, dy0 = 0; // previous segment normal and direction
+    std::uint32_t k = 0;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      float x1, y1;
+      get(i, x1, y1);
+      if (k && x1 == x0 && y1 == y0) continue;
+      if (k == 0) {
+        if (cap == cap_round) sb.add_circle(x1, y1, hw, sides);
+      } else {
+        float dx = x1 - x0;
+        float dy = y1 - y0;
+        float len = sqrtf(dx * dx + dy * dy);
+        dx /= len;
+        dy /= len;
+        float nx = -dy * hw;
+        float ny =  dx * hw;
+
+        if (k > 1) {  // join with the previous segment
+          float cross = dx0 * dy - dy0 * dx;
+          float dot   = dx0 * dx + dy0 * dy;
+          if (cross != 0.0f || dot < 0.0f) {
+            float s = (cross > 0.0f) ? -1.0f : 1.0f;  // outer side
+            sb.add(x0, y0);
+            sb.add(x0 + s * nx0, y0 + s * ny0);
+            if (join == join_round) {
+              // fan over the outer side. the chord error stays under 1/8 pixel.
+              float angle = atan2f(fabsf(cross), dot);
+              std::uint32_t steps = (std::uint32_t)(angle * sides * (1.0f / 6.2831853f));
+              if (steps) {
+                float a = -s * angle / (steps + 1);
+                float c = cosf(a), sn = sinf(a);
+                float vx = s * nx0, vy = s * ny0;
+                for (std::uint32_t j = 0; j < steps; ++j) {
+                  float t = vx * c - vy * sn;
+                  vy = vx * sn + vy * c;
+                  vx = t;
+                  sb.add(x0 + vx, y0 + vy);
+                }
+              }
+            } else {
+              float hw2 = hw * hw;
+              float c = hw2 + (nx0 * nx + ny0 * ny);  // 2 * hw^2 * cos^2 of the half angle
+              if (join == join_miter && c * 8.0f > hw2) {  // miter limit 4
+                float f = s * hw2 / c;
+                sb.add(x0 + (nx0 + nx) * f, y0 + (ny0 + ny) * f);
+              }
+            }
+            sb.add(x0 + s * nx, y0 + s * ny);
+            sb.close();
+          }
+        }
+
+        float ex0 = 0, ey0 = 0, ex1 = 0, ey1 = 0;  // square cap extensions
+        if (cap == cap_square) {
+          if (k == 1) { ex0 = -dx * hw; ey0 = -dy * hw; }
+          if (k + 1 == m) { ex1 = dx * hw; ey1 = dy * hw; }
+        }
+        sb.add(x0 + nx + ex0, y0 + ny + ey0);
+        sb.add(x1 + nx + ex1, y1 + ny + ey1);
+        sb.add(x1 - nx + ex1, y1 - ny + ey1);
+        sb.add(x0 - nx + ex0, y0 - ny + ey0);
+        sb.close();
+
+        nx0 = nx; ny0 = ny; dx0 = dx; dy0 = dy;
+        if (k + 1 == m && cap == cap_round) sb.add_circle(x1, y1, hw, sides);
+      }
+      x0 = x1;
+      y0 = y1;
+      ++k;
+    }
+    if (m == 1 && cap == cap_square) {
+      sb.add(x0 - hw, y0 - hw);
+      sb.add(x0 + hw, y0 - hw);
+      sb.add(x0 + hw, y0 + hw);
+      sb.add(x0 - hw, y0 + hw);
+      sb.close();
+    }
+  }
+
+  template <typename TGet>
+  static bool build_stroke(stroke_builder_t& sb, TGet get, std::uint32_t count, float width, line_cap_t cap, line_join_t join)
+  {
+    float hw = width * 0.5f;
+    std::uint32_t sides = stroke_round_sides(hw);
+    std::uint32_t m = stroke_distinct(get, count);
+    std::uint32_t points = 0, contours = 0;
+    stroke_room(m, sides, points, contours);
+    if (!stroke_alloc(sb, points, contours)) return false;
+    add_stroke(sb, get, count, m, hw, sides, cap, join);
+    return true;
+  }
+
+  void LGFXBase::drawWideLine(float x0, float y0, float x1, float y1, float width, line_cap_t cap)
+  {
+    float xy[4] = { x0, y0, x1, y1 };
+    stroke_builder_t sb;
+    if (!build_stroke(sb, [&](std::uint32_t i, float& x, float& y) { x = xy[i * 2]; y = xy[i * 2 + 1]; }, 2, width, cap, join_miter)) return;
+    fill_polygon(sb.points, sb.counts, sb.ncontours, non_zero, stroke_builder_t::shift);
+    heap_free(sb.points);
+  }
+
+  void LGFXBase::drawPolylineStroke(const point_t* points, std::uint32_t count, float width, line_cap_t cap, line_join_t join)
+  {
+    if (!count) return;
+    stroke_builder_t sb;
+    if (!build_stroke(sb, [&](std::uint32_t i, float& x, float& y) { x = points[i].x; y = points[i].y; }, count, width, cap, join)) return;
+    fill_polygon(sb.points, sb.counts, sb.ncontours, non_zero, stroke_builder_t::shift);
+    heap_free(sb.points);
+  }
+
+  void LGFXBase::fillPath(const LGFX_Path& path, fill_rule_t rule)
+  {
+    if (!path.flatten()) return;
+    fill_polygon(path.points(), path.counts(), path.contours(), rule, LGFX_Path::shift);
+  }
+
+  void LGFXBase::drawPath(const LGFX_Path& path, float width, line_cap_t cap, line_join_t join)
+  {
+    if (!path.flatten() || !path.contours()) return;
+    float hw = width * 0.5f;
+    std::uint32_t sides = stroke_round_sides(hw);
+    auto pts = path.points();
+    auto counts = path.counts();
+    static constexpr float scale = 1.0f / (1 << LGFX_Path::shift);
+
+    // the path is in the coordinates of fillPath (pixel centres at +0.5), the stroke is centred on the filled edge.
+    // closed contours go round once more up to the second point, so the start gets a join instead of caps.
+    std::uint32_t points = 0, contours = 0;
+    const point_t* p = pts;
+    for (std::uint32_t c = 0; c < path.contours(); ++c) {
+      std::uint32_t n = counts[c];
+      std::uint32_t len = path.isClosed(c) ? n + 2 : n;
+      auto get = [&](std::uint32_t i, float& x, float& y) { if (i >= n) i -= n; x = p[i].x * scale - 0.5f; y = p[i].y * scale - 0.5f; };
+      stroke_room(stroke_distinct(get, len), sides, points, contours);
+      p += n;
+    }
+    stroke_builder_t sb;
+    if (!stroke_alloc(sb, points, contours)) return;
+    p = pts;
+    for (std::uint32_t c = 0; c < path.contours(); ++c) {
+      std::uint32_t n = counts[c];
+      bool closed = path.isClosed(c);
+      std::uint32_t len = closed ? n + 2 : n;
+      auto get = [&](std::uint32_t i, float& x, float& y) { if (i >= n) i -= n; x = p[i].x * scale - 0.5f; y = p[i].y * scale - 0.5f; };
+      add_stroke(sb, get, len, stroke_distinct(get, len), hw, sides, closed ? cap_butt : cap, join);
+      p += n;
+    }
+    fill_polygon(sb.points, sb.counts, sb.ncontours, non_zero, stroke_builder_t::shift);
+    heap_free(sb.points);
+  }
+
+  void LGFXBase::draw_display_list(const display_command_t* first, const display_command_t* last, std::int32_t x, std::int32_t y)
+  {
+    typedef display_command_t L;
+    // the clip in list coordinates
+    std::int32_t cl = _clip_l - x, cr = _clip_r - x, ct = _clip_t - y, cb = _clip_b - y;
+    if (cl > cr || ct > cb || first == last) return;
+
+    auto color = _color.raw;
+    std::uint32_t rgb = 0;
+    bgr888_t buf[64];
+    pixelcopy_t pc(buf, _write_conv.depth, rgb888_3Byte, hasPalette());
+
+    startWrite();
+    for (auto c = first; c != last; c = c->next()) {
+      auto op = c->op();
+      if (op == L::op_fill && c->words() * sizeof(std::uint32_t) > sizeof(L)) {  // colour change
+        rgb = *(const std::uint32_t*)c->data();
+        _color.raw = _write_conv.convert_rgb888(rgb);
+      }
+      if (c->r < cl || c->l > cr || c->b < ct || c->t > cb) continue;
+      if (_clip_count) {
+        bool hit = false;
+        for (std::uint32_t i = 0; i < _clip_count && !hit; ++i) {
+          auto& k = _clip_rects[i];
+          hit = !(c->r + x < k.l || c->l + x > k.r || c->b + y < k.t || c->t + y > k.b);
+        }
+        if (!hit) continue;
+      }
+      std::int32_t l = std::max<std::int32_t>(c->l, cl), r = std::min<std::int32_t>(c->r, cr);
+      std::int32_t t = std::max<std::int32_t>(c->t, ct), b = std::min<std::int32_t>(c->b, cb);
+      std::int32_t w = r - l + 1, h = b - t + 1;
+
+      switch (op) {
+      case L::op_fill:
+        fill_span(l + x, t + y, w, h);
+        break;
+
+      case L::op_alpha:
+        {
+          // rows : column offset, length, alpha bytes
+          auto p = (const std::uint32_t*)c->data();
+          auto a = (const std::uint8_t*)&p[1];
+          set_smooth_color(p[0]);
+          for (std::int32_t yy = c->t; yy <= b; a += 2 + a[1], ++yy) {
+            if (yy < t) continue;
+            std::int32_t xs = c->l + a[0];
+            std::int32_t xe = xs + a[1] - 1;
+            std::int32_t ls = std::max(xs, l), le = std::min(xe, r);
+            if (ls <= le) write_coverage(ls + x, yy + y, le - ls + 1, &a[2 + ls - xs]);
+          }
+          _color.raw = _write_conv.convert_rgb888(rgb);
+        }
+        break;
+
+      case L::op_pixels:
+        {
+          std::uint32_t stride = ((c->r - c->l + 1) * 3 + 3) & ~3;
+          pixelcopy_t p(&((const std::uint8_t*)c->data())[(t - c->t) * stride + (l - c->l) * 3], _write_conv.depth, rgb888_3Byte, hasPalette());
+          push_image(l + x, t + y, w, h, &p, false, stride);
+        }
+        break;
+
+      case L::op_image:
+        {
+          // converted to bgr888 in chunks, then pushed in opaque runs.
+          pixelcopy_t src;
+          memcpy(&src, c->data(), sizeof(pixelcopy_t));
+          std::uint32_t sx = src.src_x32 + (l - c->l) * src.src_x32_add;
+          std::uint32_t sy = src.src_y32 + (l - c->l) * src.src_y32_add + ((t - c->t) << FP_SCALE);
+          for (std::int32_t yy = t; yy <= b; ++yy, sy += 1 << FP_SCALE) {
+            src.src_x32 = sx;
+            src.src_y32 = sy;
+            for (std::int32_t pos = l; pos <= r; pos += 64) {
+              std::int32_t len = std::min<std::int32_t>(64, r + 1 - pos);
+              std::int32_t i = 0;
+              for (;;) {
+                std::int32_t j = src.fp_copy(buf, i, len, &src);
+                if (j > i) {
+                  pc.src_data = &buf[i];
+                  push_image(pos + i + x, yy + y, j - i, 1, &pc);
+                }
+                if (j >= len || src.fp_skip == nullptr) break;
+                i = src.fp_skip(j, len, &src);
+                if (i >= len) break;
+              }
+            }
+          }
+        }
+        break;
+
+      case L::op_copy:
+        {
+          auto p = *(const std::uint32_t*)c->data();
+          std::int32_t sx = (std::int16_t)p + (l - c->l) + x;
+          std::int32_t sy = (std::int16_t)(p >> 16) + (t - c->t) + y;
+          copyRect(l + x, t + y, w, h, sx, sy);
+        }
+        break;
+
+      default:
+        break;
+      }
+    }
+    endWrite();
+    _color.raw = color;
+  }
+
+  void LGFXBase::draw_display_list(const display_command_t* first, const display_command_t* last, std::int32_t x, std::int32_t y, std::int32_t clip_x, std::int32_t clip_y, std::int32_t clip_w, std::int32_t clip_h)
+  {
+    _adjust_abs(clip_x, clip_w);
+    _adjust_abs(clip_y, clip_h);
+    std::int32_t l = _clip_l, r = _clip_r, t = _clip_t, b = _clip_b;
+    _clip_l = std::max(l, clip_x);
+    _clip_r = std::min(r, clip_x + clip_w - 1);
+    _clip_t = std::max(t, clip_y);
+    _clip_b = std::min(b, clip_y + clip_h - 1);
+    draw_display_list(first, last, x, y);
+    _clip_l = l;
+    _clip_r = r;
+    _clip_t = t;
+    _clip_b = b;
+  }
+
+  void LGFXBase::writeAlphaSpan_impl(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* alpha)
+  {
+    std::int32_t fore_r = (_smooth_rgb888 >> 16) & 0xFF;
+    std::int32_t fore_g = (_smooth_rgb888 >>  8) & 0xFF;
+    std::int32_t fore_b = (_smooth_rgb888      ) & 0xFF;
+
+    if (!isReadable() || hasPalette()) {
+      // no readback : blend with the base colour. palette : draw the pixels covered over half.
+      std::int32_t back_r = (_base_rgb888 >> 16) & 0xFF;
+      std::int32_t back_g = (_base_rgb888 >>  8) & 0xFF;
+      std::int32_t back_b = (_base_rgb888      ) & 0xFF;
+      auto color = _color;
+      for (std::int32_t i = 0; i < w; ++i) {
+        std::int32_t a = alpha[i];
+        if (hasPalette()) {
+          if (a < 128) continue;
         } else {
-          if (len) {
-            writeFastHLine(cx + x - len, cy + y, len);
-            len = 0;
+          if (!a) continue;
+          std::int32_t p = a + 1;
+          _color.raw = _write_conv.convert(color888( (fore_r * p + back_r * (256 - p)) >> 8
+                                                   , (fore_g * p + back_g * (256 - p)) >> 8
+                                                   , (fore_b * p + back_b * (256 - p)) >> 8 ));
+        }
+        writeFillRect_impl(x + i, y, 1, 1);
+      }
+      _color = color;
+      return;
+    }
+
+    // span-wise read-modify-write
+    bgr888_t buf[64];
+    pixelcopy_t p(buf, _write_conv.depth, rgb888_3Byte, false);
+    while (w > 0) {
+      std::int32_t len = (w < 64) ? w : 64;
+      readRectRGB(x, y, len, 1, buf);
+      for (std::int32_t i = 0; i < len; ++i) {
+        std::int32_t a = alpha[i];
+        if (!a) continue;
+        std::int32_t pa = a + 1;
+        auto bgr = &buf[i];
+        bgr->r = (fore_r * pa + bgr->r * (256 - pa)) >> 8;
+        bgr->g = (fore_g * pa + bgr->g * (256 - pa)) >> 8;
+        bgr->b = (fore_b * pa + bgr->b * (256 - pa)) >> 8;
+      }
+      push_image(x, y, len, 1, &p);
+      x += len;
+      alpha += len;
+      w -= len;
+    }
+  }
+
+  void LGFXBase::write_coverage(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* coverage)
+  {
+    if (!_clip_count) { write_coverage_run(x, y, w, coverage); return; }
+    std::int32_t xe = x + w - 1;
+    for (std::uint32_t i = 0; i < _clip_count; ++i) {
+      auto& c = _clip_rects[i];
+      if (y < c.t || y > c.b) continue;
+      std::int32_t l = std::max<std::int32_t>(x, c.l), r = std::min<std::int32_t>(xe, c.r);
+      if (l <= r) write_coverage_run(l, y, r - l + 1, &coverage[l - x]);
+    }
+  }
+
+  void LGFXBase::write_coverage_run(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* coverage)
+  {
+    std::int32_t i = 0;
+    while (i < w) {
+      std::int32_t j = i;
+      std::uint8_t c = coverage[i];
+      if (c == 0) {
+        while (++j < w && coverage[j] == 0);
+      } else if (c == 255) {
+        while (++j < w && coverage[j] == 255);
+        writeFillRect_impl(x + i, y, j - i, 1);
+      } else {
+        while (++j < w && coverage[j] != 0 && coverage[j] != 255);
+        writeAlphaSpan_impl(x + i, y, j - i, &coverage[i]);
+      }
+      i = j;
+    }
+  }
+
+  void LGFXBase::draw_smooth_line(float x0, float y0, float x1, float y1)
+  {
+    bool steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+    if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+
+    float dx = x1 - x0;
+    float gradient = (dx == 0.0f) ? 1.0f : (y1 - y0) / dx;
+
+    std::int32_t clip_lo = steep ? _clip_t : _clip_l;   // major axis
+    std::int32_t clip_hi = steep ? _clip_b : _clip_r;
+    std::int32_t minor_lo = steep ? _clip_l : _clip_t;  // minor axis
+    std::int32_t minor_hi = steep ? _clip_r : _clip_b;
+
+    // two pixels across the line at major position m
+    auto plot = [&](std::int32_t m, std::int32_t n, std::uint8_t a0, std::uint8_t a1)
+    {
+      if (m < clip_lo || m > clip_hi || n < minor_lo - 1 || n > minor_hi) return;
+      std::uint8_t a[2] = { a0, a1 };
+      if (steep) {
+        std::int32_t l = (n < minor_lo) ? 1 : 0;
+        std::int32_t r = (n + 1 > minor_hi) ? 1 : 2;
+        write_coverage(n + l, m, r - l, &a[l]);
+      } else {
+        if (n >= minor_lo)     write_coverage(m, n    , 1, &a[0]);
+        if (n + 1 <= minor_hi) write_coverage(m, n + 1, 1, &a[1]);
+      }
+    };
+
+    startWrite();
+
+    // end points
+    std::int32_t m0 = (std::int32_t)floorf(x0 + 0.5f);
+    std::int32_t m1 = (std::int32_t)floorf(x1 + 0.5f);
+    for (std::int32_t k = 0; k < 2; ++k) {
+      float xe = k ? x1 : x0;
+      std::int32_t m = k ? m1 : m0;
+      float yend = (k ? y1 : y0) + gradient * (m - xe);
+      float xgap = (m0 == m1) ? dx  // both ends in the same pixel column
+                 : k ? (x1 + 0.5f - m) : (m + 0.5f - x0);
+      if (xgap <= 0.0f) break;
+      std::int32_t n = (std::int32_t)floorf(yend);
+      float f = yend - n;
+      plot(m, n, (std::uint8_t)((1.0f - f) * xgap * 255.0f), (std::uint8_t)(f * xgap * 255.0f));
+      if (m0 == m1) break;
+    }
+
+    // main span, clipped on the major axis.
+    std::int32_t ms = std::max(m0 + 1, clip_lo);
+    std::int32_t me = std::min(m1 - 1, clip_hi);
+    if (ms <= me) {
+      std::int64_t fy = (std::int64_t)((y0 + gradient * (ms - x0)) * 65536.0f);
+      std::int32_t fg = (std::int32_t)(gradient * 65536.0f);
+      for (std::int32_t m = ms; m <= me; ++m, fy += fg) {
+        std::int32_t n = (std::int32_t)(fy >> 16);
+        std::uint8_t f = (std::uint8_t)(fy >> 8);
+        plot(m, n, 255 - f, f);
+      }
+    }
+
+    endWrite();
+  }
+
+  struct LGFXBase::smooth_arc_t
+  {
+    float sx, sy;  // start direction
+    float ex, ey;  // end direction
+    float mx, my;  // middle direction
+    bool reflex;   // sweep over 180 degrees
+  };
+
+  void LGFXBase::fill_smooth_arc(float x, float y, float r0, float r1, float start, float end)
+  {
+    if (r0 < r1) std::swap(r0, r1);
+
+    std::uint32_t s = degree_to_angle(start);
+    std::uint32_t sweep = (degree_to_angle(end) - s) & 0xFFFF;
+    if (!sweep && fabsf(end - start) > 180) sweep = 0x10000;
+
+    if (sweep >= 0x10000) {
+      fill_smooth_helper(x, y, r0 + 0.5f, r0 + 0.5f, r1 - 0.5f, r1 - 0.5f);
+      return;
+    }
+    std::uint32_t e = s + sweep;
+    std::uint32_t m = s + (sweep >> 1);
+    static constexpr float q15 = 1.0f / 32768;
+    smooth_arc_t arc = { sin_q15(s + 0x4000) * q15, sin_q15(s) * q15
+                       , sin_q15(e + 0x4000) * q15, sin_q15(e) * q15
+                       , sin_q15(m + 0x4000) * q15, sin_q15(m) * q15
+                       , sweep > 0x8000 };
+    fill_smooth_helper(x, y, r0 + 0.5f, r0 + 0.5f, r1 - 0.5f, r1 - 0.5f, &arc);
+  }
+
+  // half width of the row dy of an ellipse grown by d. negative when the row misses it.
+  static float smooth_extent(float rx, float ry, float d, float dy)
+  {
+    rx += d;
+    ry += d;
+    if (rx <= 0 || ry <= 0) return -1;
+    float t = 1.0f - (dy * dy) / (ry * ry);
+    return (t > 0) ? rx * sqrtf(t) : -1;
+  }
+
+  // signed distance from the edge of an ellipse, positive inside.
+  static float smooth_distance(float rx, float ry, float dx, float dy)
+  {
+    if (rx == ry) return rx - sqrtf(dx * dx + dy * dy);
+    float ax = dx / (rx * rx);
+    float ay = dy / (ry * ry);
+    float g = 2.0f * sqrtf(ax * ax + ay * ay);
+    return (g > 0) ? (1.0f - dx * ax - dy * ay) / g : rx;
+  }
+
+  static float smooth_clamp(float v) { return (v <= 0.0f) ? 0.0f : (v >= 1.0f) ? 1.0f : v; }
+
+  void LGFXBase::fill_smooth_helper(float cx, float cy, float orx, float ory, float irx, float iry, const smooth_arc_t* arc)
+  {
+    if (orx <= 0 || ory <= 0) return;
+    bool hole = irx > 0 && iry > 0;
+
+    std::int32_t ys = std::max(_clip_t, (std::int32_t)ceilf(cy - ory - 0.5f));
+    std::int32_t ye = std::min(_clip_b, (std::int32_t)floorf(cy + ory + 0.5f));
+    std::uint8_t cov[64];
+
+    startWrite();
+    for (std::int32_t y = ys; y <= ye; ++y) {
+      float dy = y - cy;
+      float xo = smooth_extent(orx, ory, 0.5f, dy);         // nothing beyond
+      if (xo < 0) continue;
+      float xh = hole ? smooth_extent(irx, iry, -0.5f, dy) : -1;  // nothing within
+      float xf = arc ? -1 : smooth_extent(orx, ory, -0.5f, dy);   // fully covered within
+      float xfi = (hole && !arc) ? smooth_extent(irx, iry, 0.5f, dy) : 0;  // and beyond
+
+      std::int32_t seg[2][2] = { { (std::int32_t)ceilf(cx - xo), (std::int32_t)floorf(cx + xo) }, { 0, -1 } };
+      if (xh >= 0) {
+        seg[1][0] = (std::int32_t)ceilf(cx + xh);
+        seg[1][1] = seg[0][1];
+        seg[0][1] = (std::int32_t)floorf(cx - xh);
+      }
+      for (std::int32_t s = 0; s < 2; ++s) {
+        std::int32_t xl = std::max(_clip_l, seg[s][0]);
+        std::int32_t xr = std::min(_clip_r, seg[s][1]);
+        while (xl <= xr) {
+          std::int32_t len = std::min(xr - xl + 1, 64);
+          for (std::int32_t i = 0; i < len; ++i) {
+            float dx = xl + i - cx;
+            float adx = fabsf(dx);
+            if (adx <= xf && adx >= xfi) {
+              cov[i] = 255;
+              continue;
+            }
+            float c = smooth_clamp(0.5f + smooth_distance(orx, ory, dx, dy));
+            if (hole) c = std::min(c, smooth_clamp(0.5f - smooth_distance(irx, iry, dx, dy)));
+            if (arc) {
+              float cs = smooth_clamp(0.5f + arc->sx * dy - arc->sy * dx);
+              float ce = smooth_clamp(0.5f + arc->ey * dx - arc->ex * dy);
+              if (arc->reflex) {
+                c = std::min(c, std::max(cs, ce));
+              } else {
+                float cm = smooth_clamp(0.5f + arc->mx * dx + arc->my * dy);
+                c = std::min(c, std::min(cm, std::min(cs, ce)));
+              }
+            }
+            cov[i] = (std::uint8_t)(c * 255.0f + 0.5f);
           }
-          if (distance >= or2) break;
-          if (x < 0 && distance < ir2) { x = -x; }
+          write_coverage(xl, y, len, cov);
+          xl += len;
         }
-      } while (++x <= xe);
-    } while (++y <= ye);
+      }
+    }
+    endWrite();
+  }
+
+  // the rows are expanded by nibbles and pushed as an image, the background runs are skipped when transparent.
+  void LGFXBase::push_bitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor, bool lsb_first)
+  {
+    bitmap_expand_t e;
+    std::uint32_t bytes = _write_conv.bytes;
+    e.init(fg_rawcolor, bg_rawcolor, bytes, lsb_first);
+    pixelcopy_t p(bitmap, getColorDepth(), palette_1bit, hasPalette(), &e, (bg_rawcolor == ~0u) ? 0 : ~0u);
+    p.fp_copy = (bytes == 1) ? pixelcopy_t::bitmapcopy<1>
+              : (bytes == 2) ? pixelcopy_t::bitmapcopy<2>
+                             : pixelcopy_t::bitmapcopy<3>;
+    p.fp_skip = pixelcopy_t::bitmapskip;
+    push_image(x, y, w, h, &p);
   }
 
   void LGFXBase::draw_bitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor)
   {
     if (w < 1 || h < 1) return;
+    if (_write_conv.bytes) {
+      push_bitmap(x, y, bitmap, w, h, fg_rawcolor, bg_rawcolor, false);
+      return;
+    }
     setRawColor(fg_rawcolor);
     std::int32_t byteWidth = (w + 7) >> 3;
     std::uint_fast8_t byte = 0;
@@ -877,6 +2222,10 @@ namespace lgfx
   void LGFXBase::draw_xbitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor)
   {
     if (w < 1 || h < 1) return;
+    if (_write_conv.bytes) {
+      push_bitmap(x, y, bitmap, w, h, fg_rawcolor, bg_rawcolor, true);
+      return;
+    }
     setRawColor(fg_rawcolor);
     std::int32_t byteWidth = (w + 7) >> 3;
     std::uint_fast8_t byte = 0;
@@ -904,7 +2253,7 @@ namespace lgfx
     endWrite();
   }
 
-  void LGFXBase::push_image(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t *param, bool use_dma)
+  void LGFXBase::push_image(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t *param, bool use_dma, std::uint32_t src_stride)
   {
     param->src_width = w;
     if (param->src_bits < 8) {        // get bitwidth
@@ -915,6 +2264,7 @@ namespace lgfx
                                                     : 1;
       param->src_width = (w + x_mask) & (~x_mask);
     }
+    param->src_stride = src_stride ? src_stride : (param->src_width * param->src_bits >> 3);
 
     std::int32_t dx=0, dw=w;
     if (0 < _clip_l - x) { dx = _clip_l - x; dw -= dx; x = _clip_l; }
@@ -929,20 +2279,32 @@ namespace lgfx
     param->src_y = dy;
 
     startWrite();
-    pushImage_impl(x, y, dw, dh, param, use_dma);
+    if (!_clip_count) pushImage_impl(x, y, dw, dh, param, use_dma);
+    else {
+      std::int32_t xe = x + dw - 1, ye = y + dh - 1;
+      for (std::uint32_t i = 0; i < _clip_count; ++i) {
+        auto& c = _clip_rects[i];
+        std::int32_t l = std::max<std::int32_t>(x, c.l), r = std::min<std::int32_t>(xe, c.r);
+        std::int32_t t = std::max<std::int32_t>(y, c.t), b = std::min<std::int32_t>(ye, c.b);
+        if (l > r || t > b) continue;
+        param->src_x = dx + l - x;
+        param->src_y = dy + t - y;
+        pushImage_impl(l, t, r - l + 1, b - t + 1, param, use_dma);
+      }
+    }
     endWrite();
   }
 
-  bool LGFXBase::pushImageRotateZoom(std::int32_t dst_x, std::int32_t dst_y, const void* data, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, std::uint32_t transparent, const std::uint8_t bits, const bgr888_t* palette)
+  bool LGFXBase::pushImageRotateZoom(std::int32_t dst_x, std::int32_t dst_y, const void* data, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, std::uint32_t transparent, const std::uint8_t bits, const bgr888_t* palette, std::uint32_t src_stride)
   {
     if (nullptr == data) return false;
     if (zoom_x == 0.0 || zoom_y == 0.0) return true;
     pixelcopy_t pc(data, getColorDepth(), (color_depth_t)bits, hasPalette(), palette, transparent );
-    push_image_rotate_zoom(dst_x, dst_y, src_x, src_y, w, h, angle, zoom_x, zoom_y, &pc);
+    push_image_rotate_zoom(dst_x, dst_y, src_x, src_y, w, h, angle, zoom_x, zoom_y, &pc, src_stride);
     return true;
   }
 
-  void LGFXBase::push_image_rotate_zoom(std::int32_t dst_x, std::int32_t dst_y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, pixelcopy_t *param)
+  void LGFXBase::push_image_rotate_zoom(std::int32_t dst_x, std::int32_t dst_y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, pixelcopy_t *param, std::uint32_t src_stride)
   {
     angle *= - deg_to_rad; // Convert degrees to radians
     float sin_f = sin(angle) * (1 << FP_SCALE);
@@ -985,6 +2347,7 @@ namespace lgfx
     } else {
       param->src_width = w;
     }
+    param->src_stride = src_stride ? src_stride : (param->src_width * param->src_bits >> 3);
 
     std::int32_t xt =       - dst_x;
     std::int32_t yt = min_y - dst_y - 1;
@@ -1029,11 +2392,25 @@ namespace lgfx
                 tmp = (ystart + ys2) / sin_y; if (right > tmp) right = tmp;
       }
       if (left < right) {
-        param->src_x32 = xstart - left * cos_x;
-        std::int32_t y32 = ystart - left * sin_y;
-        if (y32 >= 0) {
-          param->src_y32 = y32;
-          pushImage_impl(left, min_y, right - left, 1, param, true);
+        if (!_clip_count) {
+          param->src_x32 = xstart - left * cos_x;
+          std::int32_t y32 = ystart - left * sin_y;
+          if (y32 >= 0) {
+            param->src_y32 = y32;
+            pushImage_impl(left, min_y, right - left, 1, param, true);
+          }
+        } else {
+          for (std::uint32_t i = 0; i < _clip_count; ++i) {
+            auto& c = _clip_rects[i];
+            if (min_y < c.t || min_y > c.b) continue;
+            std::int32_t l = std::max<std::int32_t>(left, c.l), r = std::min<std::int32_t>(right, c.r + 1);
+            if (l >= r) continue;
+            param->src_x32 = xstart - l * cos_x;
+            std::int32_t y32 = ystart - l * sin_y;
+            if (y32 < 0) continue;
+            param->src_y32 = y32;
+            pushImage_impl(l, min_y, r - l, 1, param, true);
+          }
         }
       }
     } while (++min_y != max_y);
@@ -1059,7 +2436,12 @@ namespace lgfx
     std::int32_t dst_y = src_y + dy;
 
     startWrite();
-    copyRect_impl(dst_x, dst_y, w, h, src_x, src_y);
+    // rotating rows is only equivalent to the copy when the whole zone is inside the clip.
+    if (dx || _sx || _sw != _width
+     || _clip_count || _clip_l > 0 || _clip_r < _width - 1 || _clip_t > _sy || _clip_b < _sy + _sh - 1
+     || !scrollRows_impl(_sy, _sh, dy)) {
+      copyRect_impl(dst_x, dst_y, w, h, src_x, src_y);
+    }
 
     if (     dx > 0) writeFillRect(_sx           , dst_y,  dx, h);
     else if (dx < 0) writeFillRect(_sx + _sw + dx, dst_y, -dx, h);
@@ -1083,22 +2465,99 @@ namespace lgfx
     endWrite();
   }
 
-  struct paint_point_t { std::int32_t lx,rx,y,oy; };
-
-  static void paint_add_points(std::list<paint_point_t>& points, int lx, int rx, int y, int oy, bool* linebuf)
+  // pieces of rows read back from the target as "has the target colour" flags.
+  // a piece is CHUNK pixels wide, the least recently used one is read again.
+  struct LGFXBase::paint_reader_t
   {
-    paint_point_t pt { 0, 0, y, oy };
-    while (lx <= rx) {
-      while (lx < rx && !linebuf[lx]) ++lx;
-      if (!linebuf[lx]) break;
-      pt.lx = lx;
-      while (++lx <= rx && linebuf[lx]);
-      pt.rx = lx - 1;
-      points.push_back(pt);
+    static constexpr std::int32_t CHUNK = 64;
+    static constexpr std::int32_t SLOTS = 6;
+
+    LGFXBase* gfx;
+    pixelcopy_t* param;
+    std::int32_t cl, cr;
+    std::int32_t seed_x, seed_y;  // the fill colour is read back here when needed
+    bool has_fill;
+    bgr888_t fill_rgb;
+    std::int32_t slot_x[SLOTS], slot_y[SLOTS];
+    std::uint32_t slot_used[SLOTS];
+    std::uint32_t tick;
+    bool flags[SLOTS][CHUNK];
+
+    // flags of the piece holding x. index it by x - chunk_x(x).
+    bool* chunk(std::int32_t x, std::int32_t y)
+    {
+      std::int32_t x0 = x - (x - cl) % CHUNK;
+      std::int32_t i = 0;
+      for (; i < SLOTS; ++i) if (slot_y[i] == y && slot_x[i] == x0) break;
+      if (i == SLOTS) {
+        i = 0;
+        for (std::int32_t j = 1; j < SLOTS; ++j) if (slot_used[j] < slot_used[i]) i = j;
+        slot_x[i] = x0;
+        slot_y[i] = y;
+        read(x0, y, flags[i]);
+      }
+      slot_used[i] = ++tick;
+      return flags[i];
     }
-  }
-  void LGFXBase::paint(std::int32_t x, std::int32_t y) {
+
+    void read(std::int32_t x0, std::int32_t y, bool* l)
+    {
+      std::int32_t x1 = std::min(cr, x0 + CHUNK - 1);
+      gfx->read_rect(x0, y, x1 - x0 + 1, 1, l, param);
+      if (gfx->_clip_count) {  // pixels outside the clip region never match
+        std::int32_t x = x0;
+        while (x <= x1) {
+          std::int32_t next = x1 + 1;
+          bool inside = false;
+          for (std::uint32_t j = 0; j < gfx->_clip_count; ++j) {
+            auto& c = gfx->_clip_rects[j];
+            if (y < c.t || y > c.b || x > c.r) continue;
+            if (x >= c.l) { inside = true; next = std::min(x1, (std::int32_t)c.r) + 1; break; }
+            if (next > c.l) next = c.l;
+          }
+          if (!inside) memset(&l[x - x0], 0, next - x);
+          x = next;
+        }
+      }
+    }
+
+    bool match(std::int32_t x, std::int32_t y) { return chunk(x, y)[(x - cl) % CHUNK]; }
+    std::int32_t left(std::int32_t x, std::int32_t y)  { while (x > cl && match(x - 1, y)) --x; return x; }
+    std::int32_t right(std::int32_t x, std::int32_t y) { while (x < cr && match(x + 1, y)) ++x; return x; }
+    void fill(std::int32_t l, std::int32_t r, std::int32_t y)
+    {
+      for (std::int32_t i = 0; i < SLOTS; ++i) {  // the cached pieces no longer match. the others are read after the fill.
+        if (slot_y[i] != y) continue;
+        std::int32_t xs = std::max(l, slot_x[i]);
+        std::int32_t xe = std::min(r, slot_x[i] + CHUNK - 1);
+        if (xs <= xe) memset(&flags[i][xs - slot_x[i]], 0, xe - xs + 1);
+      }
+      gfx->writeFastHLine(l, y, r - l + 1);
+    }
+    bool filled(std::int32_t x, std::int32_t y)
+    {
+      if (!has_fill) {
+        gfx->readRectRGB(seed_x, seed_y, 1, 1, &fill_rgb);
+        has_fill = true;
+      }
+      bgr888_t c;
+      gfx->readRectRGB(x, y, 1, 1, &c);
+      return c.r == fill_rgb.r && c.g == fill_rgb.g && c.b == fill_rgb.b;
+    }
+  };
+
+  void LGFXBase::paint(std::int32_t x, std::int32_t y)
+  {
     if (x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b) return;
+    if (_clip_count && !in_clip_region(x, y)) return;
+    startWrite();
+    if (_clip_count) LGFXBase::paint_impl(x, y);  // the reader masks the rows by the region
+    else paint_impl(x, y);
+    endWrite();
+  }
+
+  void LGFXBase::paint_impl(std::int32_t x, std::int32_t y)
+  {
     bgr888_t target;
     readRectRGB(x, y, 1, 1, &target);
     if (_color.raw == _write_conv.convert(lgfx::color888(target.r, target.g, target.b))) return;
@@ -1117,82 +2576,23 @@ namespace lgfx
       break;
     }
 
-    std::int32_t cl = _clip_l;
-    int w = _clip_r - cl + 1;
-    std::uint8_t bufIdx = 0;
-    bool buf0[w], buf1[w], buf2[w];
-    bool* linebufs[3] = { buf0, buf1, buf2 };
-    std::int32_t bufY[3] = {-2, -2, -2};  // default is out of range.
-    bufY[0] = y;
-    read_rect(cl, y, w, 1, linebufs[0], &p);
-    std::list<paint_point_t> points;
-    points.push_back({x, x, y, y});
-
-    startWrite();
-    while (!points.empty()) {
-      std::int32_t y0 = bufY[bufIdx];
-      auto it = points.begin();
-      std::int32_t counter = 0;
-      while (it->y != y0 && ++it != points.end()) ++counter;
-      if (it == points.end()) {
-        if (counter < 256) {
-          ++bufIdx;
-          std::int32_t y1 = bufY[(bufIdx  )%3];
-          std::int32_t y2 = bufY[(bufIdx+1)%3];
-          it = points.begin();
-          while ((it->y != y1) && (it->y != y2) && (++it != points.end()));
-        }
-      }
-
-      bufIdx = 0;
-      if (it == points.end()) {
-        it = points.begin();
-        bufY[0] = it->y;
-        read_rect(cl, it->y, w, 1, linebufs[0], &p);
-      } else {
-        for (; bufIdx < 2; ++bufIdx) if (it->y == bufY[bufIdx]) break;
-      }
-      bool* linebuf = &linebufs[bufIdx][- cl];
-
-      int lx = it->lx;
-      int rx = it->rx;
-      int ly = it->y;
-      int oy = it->oy;
-      points.erase(it);
-      if (!linebuf[lx]) continue;
-
-      int lxsav = lx - 1;
-      int rxsav = rx + 1;
-
-      int cr = _clip_r;
-      while (lx > cl && linebuf[lx - 1]) --lx;
-      while (rx < cr && linebuf[rx + 1]) ++rx;
-
-      writeFastHLine(lx, ly, rx - lx + 1);
-      memset(&linebuf[lx], 0, rx - lx + 1);
-
-      int newy = ly - 1;
-      do {
-        if (newy == oy && lx >= lxsav && rxsav >= rx) continue;
-        if (newy < _clip_t) continue;
-        if (newy > _clip_b) continue;
-        int bidx = 0;
-        for (; bidx < 3; ++bidx) if (newy == bufY[bidx]) break;
-        if (bidx == 3) {
-          for (bidx = 0; bidx < 2 && (abs(bufY[bidx] - ly) <= 1); ++bidx);
-          bufY[bidx] = newy;
-          read_rect(cl, newy, w, 1, linebufs[bidx], &p);
-        }
-        bool* linebuf = &linebufs[bidx][- cl];
-        if (newy == oy) {
-          paint_add_points(points, lx ,lxsav, newy, ly, linebuf);
-          paint_add_points(points, rxsav ,rx, newy, ly, linebuf);
-        } else {
-          paint_add_points(points, lx ,rx, newy, ly, linebuf);
-        }
-      } while ((newy += 2) < ly + 2);
+    paint_reader_t reader;
+    reader.gfx = this;
+    reader.param = &p;
+    reader.cl = _clip_l;
+    reader.cr = _clip_r;
+    reader.seed_x = x;
+    reader.seed_y = y;
+    reader.has_fill = false;
+    reader.tick = 0;
+    for (std::int32_t i = 0; i < paint_reader_t::SLOTS; ++i) {
+      reader.slot_y[i] = INT32_MIN;
+      reader.slot_used[i] = 0;
     }
-    endWrite();
+
+    begin_spans();  // read_rect writes out the pending spans
+    if (reader.match(x, y)) flood_fill(reader, x, y);
+    end_spans();
   }
 
 }
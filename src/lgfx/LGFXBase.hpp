@@ -21,6 +21,8 @@ Contributors:
 #define LGFX_BASE_HPP_
 
 #include "lgfx_common.hpp"
+#include "LGFX_Path.hpp"
+#include "LGFX_SpanCache.hpp"
 
 namespace lgfx
 {
@@ -95,6 +97,9 @@ namespace lgfx
                                 void drawTriangle  ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
     template<typename T> inline void fillTriangle  ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const T& color)  { setColor(color); fillTriangle(x0, y0, x1, y1, x2, y2); }
                                 void fillTriangle  ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
+// polygon : pixel centre sampling. polygons sharing an edge do not overlap.
+    template<typename T> inline void fillPolygon   ( const point_t* points, std::uint32_t count, const T& color, fill_rule_t rule = non_zero) { setColor(color); fillPolygon(points, count, rule); }
+                                void fillPolygon   ( const point_t* points, std::uint32_t count, fill_rule_t rule = non_zero);
     template<typename T> inline void drawBezier    ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const T& color)  { setColor(color); drawBezier(x0, y0, x1, y1, x2, y2); }
                                 void drawBezier    ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
     template<typename T> inline void drawBezierHelper(std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const T& color)  { setColor(color); drawBezierHelper(x0, y0, x1, y1, x2, y2); }
@@ -108,10 +113,65 @@ namespace lgfx
     template<typename T> inline void fillCircleHelper(std::int32_t x, std::int32_t y, std::int32_t r, std::uint_fast8_t corners, std::int32_t delta, const T& color)  { setColor(color); fillCircleHelper(x, y, r, corners, delta); }
                                 void fillCircleHelper(std::int32_t x, std::int32_t y, std::int32_t r, std::uint_fast8_t corners, std::int32_t delta);
 
+// stroke : the outline of the wide line is filled once, joints and caps included.
+    template<typename T> inline void drawWideLine      ( float x0, float y0, float x1, float y1, float width, const T& color, line_cap_t cap = cap_round) { setColor(color); drawWideLine(x0, y0, x1, y1, width, cap); }
+                                void drawWideLine      ( float x0, float y0, float x1, float y1, float width, line_cap_t cap = cap_round);
+    template<typename T> inline void drawPolylineStroke( const point_t* points, std::uint32_t count, float width, const T& color, line_cap_t cap = cap_round, line_join_t join = join_round) { setColor(color); drawPolylineStroke(points, count, width, cap, join); }
+                                void drawPolylineStroke( const point_t* points, std::uint32_t count, float width, line_cap_t cap = cap_round, line_join_t join = join_round);
+
+// vector path. the flattened outline cached in the path is filled, or stroked with the outlines of all contours filled once.
+    template<typename T> inline void fillPath( const LGFX_Path& path, const T& color, fill_rule_t rule = non_zero) { setColor(color); fillPath(path, rule); }
+                                void fillPath( const LGFX_Path& path, fill_rule_t rule = non_zero);
+    template<typename T> inline void drawPath( const LGFX_Path& path, float width, const T& color, line_cap_t cap = cap_round, line_join_t join = join_round) { setColor(color); drawPath(path, width, cap, join); }
+                                void drawPath( const LGFX_Path& path, float width, line_cap_t cap = cap_round, line_join_t join = join_round);
+
+// anti-aliased primitives. the colour is blended into the destination by pixel coverage.
+    template<typename T> inline void drawSmoothLine   ( float x0, float y0, float x1, float y1, const T& color) { set_smooth_color(color); draw_smooth_line(x0, y0, x1, y1); }
+    template<typename T> inline void drawSmoothCircle ( float x, float y, float r            , const T& color) { set_smooth_color(color); fill_smooth_helper(x, y, r + 0.5f, r + 0.5f, r - 0.5f, r - 0.5f); }
+    template<typename T> inline void fillSmoothCircle ( float x, float y, float r            , const T& color) { set_smooth_color(color); fill_smooth_helper(x, y, r + 0.5f, r + 0.5f, 0, 0); }
+    template<typename T> inline void drawSmoothEllipse( float x, float y, float rx, float ry , const T& color) { set_smooth_color(color); fill_smooth_helper(x, y, rx + 0.5f, ry + 0.5f, rx - 0.5f, ry - 0.5f); }
+    template<typename T> inline void fillSmoothEllipse( float x, float y, float rx, float ry , const T& color) { set_smooth_color(color); fill_smooth_helper(x, y, rx + 0.5f, ry + 0.5f, 0, 0); }
+    template<typename T> inline void fillSmoothArc    ( float x, float y, float r0, float r1, float angle0, float angle1, const T& color) { set_smooth_color(color); fill_smooth_arc(x, y, r0, r1, angle0, angle1); }
+
+// gradient fills. the shapes are the same as the solid ones, the colour is stepped per span in 16.16 fixed point.
+    template<typename T> inline void fillTriangle         ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const T& color0, const T& color1, const T& color2) { fill_gouraud_triangle(x0, y0, x1, y1, x2, y2, convert_to_rgb888(color0), convert_to_rgb888(color1), convert_to_rgb888(color2)); }
+                                void fillGradientRect     ( std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h                , const linear_gradient_t& gradient);
+                                void fillGradientRect     ( std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h                , const radial_gradient_t& gradient);
+                                void fillGradientRoundRect( std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::int32_t r, const linear_gradient_t& gradient);
+                                void fillGradientRoundRect( std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::int32_t r, const radial_gradient_t& gradient);
+                                void fillGradientCircle   ( std::int32_t x, std::int32_t y                                , std::int32_t r, const linear_gradient_t& gradient);
+                                void fillGradientCircle   ( std::int32_t x, std::int32_t y                                , std::int32_t r, const radial_gradient_t& gradient);
+
     template<typename T> inline void paint    ( std::int32_t x, std::int32_t y, const T& color) { setColor(color); paint(x, y); }
     template<typename T> inline void floodFill( std::int32_t x, std::int32_t y, const T& color) { setColor(color); paint(x, y); }
                          inline void floodFill( std::int32_t x, std::int32_t y                ) {                  paint(x, y); }
 
+// bulk drawing. each call runs in one transaction with inline clipping.
+    template<typename T> inline void drawPixels  ( const point_t* points, std::uint32_t count, const T& color) { setColor(color); drawPixels  (points, count); }
+                                void drawPixels  ( const point_t* points, std::uint32_t count);
+    template<typename T>
+    void drawPixels( const point_t* points, const T* colors, std::uint32_t count)
+    {
+      std::uint32_t raw[32];
+      startWrite();
+      while (count) {
+        std::uint32_t n = (count < 32) ? count : 32;
+        for (std::uint32_t i = 0; i < n; ++i) raw[i] = _write_conv.convert(colors[i]);
+        draw_pixels(points, raw, n);
+        points += n;
+        colors += n;
+        count -= n;
+      }
+      endWrite();
+    }
+    template<typename T> inline void fillRects   ( const rect_t* rects, std::uint32_t count, const T& color) { setColor(color); fillRects   (rects, count); }
+                                void fillRects   ( const rect_t* rects, std::uint32_t count);
+    template<typename T> inline void drawPolyline( const point_t* points, std::uint32_t count, const T& color) { setColor(color); drawPolyline(points, count); }
+                                void drawPolyline( const point_t* points, std::uint32_t count);
+// count : number of segments ( points[i*2] to points[i*2+1] )
+    template<typename T> inline void drawLines   ( const point_t* points, std::uint32_t count, const T& color) { setColor(color); drawLines   (points, count); }
+                                void drawLines   ( const point_t* points, std::uint32_t count);
+
     __attribute__ ((always_inline)) inline static std::uint8_t  color332(std::uint8_t r, std::uint8_t g, std::uint8_t b) { return lgfx::color332(r, g, b); }
     __attribute__ ((always_inline)) inline static std::uint16_t color565(std::uint8_t r, std::uint8_t g, std::uint8_t b) { return lgfx::color565(r, g, b); }
     __attribute__ ((always_inline)) inline static std::uint32_t color888(std::uint8_t r, std::uint8_t g, std::uint8_t b) { return lgfx::color888(r, g, b); }
@@ -138,6 +198,15 @@ namespace lgfx
     __attribute__ ((always_inline)) inline void beginTransaction(void) { beginTransaction_impl(); }
     __attribute__ ((always_inline)) inline void endTransaction(void)   { endTransaction_impl(); }
     __attribute__ ((always_inline)) inline void waitDMA(void)  { waitDMA_impl(); }
+
+    // let data->preRead() / postRead() release the shared SPI bus while a write transaction is open.
+    void prepareTmpTransaction(DataWrapper* data) {
+      if (data->need_transaction && isSPIShared()) {
+        data->parent = this;
+        data->fp_pre_read  = tmpEndTransaction;
+        data->fp_post_read = tmpBeginTransaction;
+      }
+    }
     __attribute__ ((always_inline)) inline void setWindow(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye) { setWindow_impl(xs, ys, xe, ye); }
 
     void setSPIShared(bool shared) { _spi_shared = shared; }
@@ -147,6 +216,16 @@ namespace lgfx
     void getClipRect(std::int32_t *x, std::int32_t *y, std::int32_t *w, std::int32_t *h);
     void clearClipRect(void);
 
+    // clip region : union of rects, kept as up to CLIP_REGION_MAX disjoint pieces. getClipRect returns its bounding box.
+    // false : more pieces were needed, the clip falls back to the bounding box. setClipRect / clearClipRect end the region.
+    // scroll / copyRect and the pushBlock / pushColors window stay clipped by the bounding box only.
+    bool setClipRegion(const rect_t* rects, std::uint32_t count);
+    std::uint32_t getClipRegion(rect_t* rects) const; // rects : CLIP_REGION_MAX entries. returns the count (0 : a single clip rect)
+
+    // spans of fillCircle / fillRoundRect / fillArc are replayed from the cache (nullptr : not cached).
+    void setSpanCache(LGFX_SpanCache* cache) { _span_cache = cache; }
+    LGFX_SpanCache* getSpanCache(void) const { return _span_cache; }
+
     template <typename T>
     void setScrollRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const T& color) {
       _base_rgb888 = convert_to_rgb888(color);
@@ -160,6 +239,7 @@ namespace lgfx
     inline void drawPixel(std::int32_t x, std::int32_t y)
     {
       if (x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b) return;
+      if (_clip_count && !in_clip_region(x, y)) return;
 
       drawPixel_impl(x, y);
     }
@@ -169,13 +249,13 @@ namespace lgfx
     {
       if (x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b) return;
 
-      writeFillRect_impl(x, y, 1, 1);
+      fill_span(x, y, 1, 1);
     }
 
     __attribute__ ((always_inline)) inline 
     void writeFillRectPreclipped(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
     {
-      writeFillRect_impl(x, y, w, h);
+      fill_span(x, y, w, h);
     }
 
     __attribute__ ((always_inline)) inline
@@ -400,9 +480,14 @@ namespace lgfx
       push_image(x, y, w, h, &p, true);
     }
 
-    void push_image(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t *param, bool use_dma = false);
+    // display list replay ( LGFX_DisplayList::replay ). [first, last) is drawn at (x, y), commands outside the clip are skipped.
+    void draw_display_list(const display_command_t* first, const display_command_t* last, std::int32_t x, std::int32_t y);
+    void draw_display_list(const display_command_t* first, const display_command_t* last, std::int32_t x, std::int32_t y, std::int32_t clip_x, std::int32_t clip_y, std::int32_t clip_w, std::int32_t clip_h); // also limited to the clip rect
+
+    // src_stride : bytes per source row. (0 = packed rows)
+    void push_image(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t *param, bool use_dma = false, std::uint32_t src_stride = 0);
 
-    bool pushImageRotateZoom(std::int32_t dst_x, std::int32_t dst_y, const void* data, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, std::uint32_t transparent, const std::uint8_t bits, const bgr888_t* palette);
+    bool pushImageRotateZoom(std::int32_t dst_x, std::int32_t dst_y, const void* data, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, std::uint32_t transparent, const std::uint8_t bits, const bgr888_t* palette, std::uint32_t src_stride = 0);
 
     void scroll(std::int_fast16_t dx, std::int_fast16_t dy = 0);
 
@@ -460,8 +545,9 @@ namespace lgfx
     std::int32_t _width = 0, _height = 0;
     std::int32_t  _sx, _sy, _sw, _sh; // for scroll zone
 
-    std::int32_t _clip_l = 0, _clip_r = -1, _clip_t = 0, _clip_b = -1; // clip rect
+    std::int32_t _clip_l = 0, _clip_r = -1, _clip_t = 0, _clip_b = -1; // clip rect (bounding box of the clip region)
     std::uint32_t _base_rgb888 = 0;  // gap fill colour for scroll zone 
+    std::uint32_t _smooth_rgb888 = 0; // foreground of the anti-aliased primitives
     raw_color_t _color = 0xFFFFFFU;
 
     color_conv_t _write_conv;
@@ -476,6 +562,155 @@ namespace lgfx
     bool _spi_shared = true;
     bool _swapBytes = false;
 
+    // span batching for the fill primitives.
+    // the writeFillRect family stores the rects here while a primitive is running,
+    // vertical runs and overlapping spans of the same colour are merged before writeFillRect_impl.
+    static constexpr std::uint32_t SPAN_SLOTS = 4;
+    struct span_t { std::int32_t x, y, w, h; };
+    span_t _spans[SPAN_SLOTS];
+    std::uint32_t _span_color = 0;
+    std::uint8_t _span_count = 0;
+    std::uint8_t _span_batch = 0;  // nest count
+
+    __attribute__ ((always_inline)) inline void begin_spans(void) { ++_span_batch; }
+    __attribute__ ((always_inline)) inline void end_spans(void) { if (0 == --_span_batch && _span_count) flush_spans(); }
+    __attribute__ ((always_inline)) inline void fill_span(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
+      if (_clip_count) fill_span_region(x, y, w, h);
+      else put_span(x, y, w, h);
+    }
+    __attribute__ ((always_inline)) inline void put_span(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
+      if (_gradient) gradient_fill(x, y, w, h);
+      else if (_span_batch) push_span(x, y, w, h);
+      else writeFillRect_impl(x, y, w, h);
+    }
+    void push_span(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h);
+
+    // span cache. while recording, the writeFillRect family also stores the spans relative to _span_ox, _span_oy.
+    LGFX_SpanCache* _span_cache = nullptr;
+    bool _span_record = false;
+    std::int32_t _span_ox = 0, _span_oy = 0;
+    bool draw_cached(const LGFX_SpanCache::key_t& key, std::int32_t x, std::int32_t y); // true : drawn from the cache
+    void store_cached(void);
+
+    // clip region. while _clip_count != 0, output inside the bounding box is split over these pieces.
+    struct clip_rect_t { std::int16_t l, t, r, b; };  // inclusive
+    static constexpr std::uint32_t CLIP_REGION_MAX = 8;
+    clip_rect_t _clip_rects[CLIP_REGION_MAX];
+    std::uint8_t _clip_count = 0;
+
+    bool in_clip_region(std::int32_t x, std::int32_t y) const
+    {
+      for (std::uint32_t i = 0; i < _clip_count; ++i) {
+        auto& c = _clip_rects[i];
+        if (x >= c.l && x <= c.r && y >= c.t && y <= c.b) return true;
+      }
+      return false;
+    }
+    void fill_span_region(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h);
+    void draw_pixels(const point_t* points, const std::uint32_t* rawcolors, std::uint32_t count);
+    void write_coverage_run(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* coverage);
+
+    // gradient paint. while set, the spans of the fill primitives are coloured by it.
+    struct gradient_t;
+    const gradient_t* _gradient = nullptr;
+    void gradient_fill(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h);
+    void gradient_row(bgr888_t* buf, std::int32_t x, std::int32_t y, std::int32_t len) const;
+    void fill_gouraud_triangle(std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, std::uint32_t rgb0, std::uint32_t rgb1, std::uint32_t rgb2);
+
+    // flood fill on a fixed-capacity span stack. an entry : [l, r] on row y is filled, row y + dy is searched next.
+    struct paint_span_t { std::int16_t y, l, r; std::int8_t dy; };
+    static constexpr std::uint32_t PAINT_STACK_SIZE = 256;  // 2 KiB on the stack
+    struct paint_reader_t;
+    virtual void paint_impl(std::int32_t x, std::int32_t y);
+
+    // TSurface :
+    //   bool match(x, y)        the pixel has the target colour
+    //   std::int32_t left(x, y) / right(x, y)  end of the target run through a matching pixel, within the clip
+    //   void fill(l, r, y)      paint the run. its pixels no longer match.
+    //   bool filled(x, y)       the pixel has the fill colour
+    template <typename TSurface>
+    void flood_fill(TSurface& s, std::int32_t x, std::int32_t y)
+    {
+      paint_span_t stack[PAINT_STACK_SIZE];
+      std::uint32_t sp = 0;
+      std::int32_t ct = _clip_t, cb = _clip_b;
+      // bounds of the spans dropped on overflow. [0] : searched upward, [1] : searched downward.
+      struct lost_t { std::int32_t l, r, t, b; };
+      const lost_t none = { INT32_MAX, INT32_MIN, INT32_MAX, INT32_MIN };
+      lost_t lost[2] = { none, none };
+
+      auto push = [&](std::int32_t py, std::int32_t l, std::int32_t r, std::int32_t dy)
+      {
+        std::int32_t ny = py + dy;
+        if (ny < ct || ny > cb) return;
+        if (sp < PAINT_STACK_SIZE) {
+          stack[sp++] = { (std::int16_t)py, (std::int16_t)l, (std::int16_t)r, (std::int8_t)dy };
+          return;
+        }
+        auto& a = lost[dy > 0];
+        if (a.l > l ) a.l = l;
+        if (a.r < r ) a.r = r;
+        if (a.t > ny) a.t = ny;
+        if (a.b < ny) a.b = ny;
+      };
+
+      auto seed = [&](std::int32_t sx, std::int32_t sy)
+      {
+        std::int32_t l = s.left(sx, sy);
+        std::int32_t r = s.right(sx, sy);
+        s.fill(l, r, sy);
+        push(sy, l, r, -1);
+        push(sy, l, r,  1);
+
+        while (sp) {
+          auto e = stack[--sp];
+          std::int32_t dy = e.dy;
+          std::int32_t py = e.y + dy;
+          std::int32_t x1 = e.l;
+          std::int32_t x2 = e.r;
+          std::int32_t px = x1;
+          if (s.match(px, py)) {  // the run may reach out to the left
+            l = s.left(px, py);
+            r = s.right(px, py);
+            s.fill(l, r, py);
+            push(py, l, r, dy);
+            if (l < x1) push(py, l, x1 - 1, -dy);  // turns back around the left end
+            if (r > x2) push(py, x2 + 1, r, -dy);  // turns back around the right end
+            px = r + 1;
+          }
+          while (++px <= x2) {
+            if (!s.match(px, py)) continue;
+            r = s.right(px, py);
+            s.fill(px, r, py);
+            push(py, px, r, dy);
+            if (r > x2) push(py, x2 + 1, r, -dy);
+            px = r + 1;
+          }
+        }
+      };
+
+      seed(x, y);
+
+      // after an overflow, the dropped area is searched again : a target pixel is seeded when
+      // its neighbour on the side it was searched from has the fill colour.
+      // (a target area touching the fill colour drawn before, from that side and inside the area, is filled too.)
+      for (;;) {
+        std::int32_t i = (lost[0].t > lost[0].b);
+        lost_t a = lost[i];
+        if (a.t > a.b) break;
+        lost[i] = none;
+        std::int32_t dy = i ? 1 : -1;
+        for (std::int32_t py = a.t; py <= a.b; ++py) {
+          for (std::int32_t px = a.l; px <= a.r; ++px) {
+            if (s.match(px, py) && s.filled(px, py - dy)) seed(px, py);
+          }
+        }
+      }
+    }
+    void flush_spans(void);
+
     __attribute__ ((always_inline)) inline static bool _adjust_abs(std::int32_t& x, std::int32_t& w) { if (w < 0) { x += w + 1; w = -w; } return !w; }
 
     static bool _adjust_width(std::int32_t& x, std::int32_t& dx, std::int32_t& dw, std::int32_t left, std::int32_t width)
@@ -497,22 +732,40 @@ namespace lgfx
       if (h > _height - y) h = _height - y;
       if (h < 1) return;
 
+      if (_span_count) flush_spans();
       startWrite();
       readRect_impl(x, y, w, h, dst, param);
       endWrite();
     }
 
-    void fill_arc_helper(std::int32_t cx, std::int32_t cy, std::int32_t oradius, std::int32_t iradius, float start, float end);
+    void fill_polygon(const point_t* points, const std::uint32_t* counts, std::uint32_t contours, fill_rule_t rule, std::uint32_t shift); // shift : fraction bits of the coordinates
+    void fill_arc_helper(std::int32_t cx, std::int32_t cy, std::int32_t oradius, std::int32_t iradius, std::uint32_t start, std::uint32_t sweep); // angle : 0x10000 per turn
+
+    struct smooth_arc_t;
+    // the rgb888 value is only used for blending. on a palette target the colour is an index and is converted as given.
+    template<typename T>
+    void set_smooth_color(const T& color)
+    {
+      _smooth_rgb888 = convert_to_rgb888(color);
+      _color.raw = hasPalette() ? _write_conv.convert(color) : _write_conv.convert(_smooth_rgb888);
+    }
+    void draw_smooth_line(float x0, float y0, float x1, float y1);
+    void fill_smooth_arc(float x, float y, float r0, float r1, float start, float end);
+    void fill_smooth_helper(float cx, float cy, float orx, float ory, float irx, float iry, const smooth_arc_t* arc = nullptr); // radius <= 0 : no hole
+    void write_coverage(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* coverage); // clipped by the bounding box
     void draw_bitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor = ~0u);
     void draw_xbitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor = ~0u);
-    void push_image_rotate_zoom(std::int32_t dst_x, std::int32_t dst_y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, pixelcopy_t *param);
+    void push_bitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor, bool lsb_first); // 1-3 byte targets
+    void push_image_rotate_zoom(std::int32_t dst_x, std::int32_t dst_y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, float angle, float zoom_x, float zoom_y, pixelcopy_t *param, std::uint32_t src_stride = 0);
 
     virtual void beginTransaction_impl(void) = 0;
     virtual void endTransaction_impl(void) = 0;
     virtual void waitDMA_impl(void) = 0;
 
     virtual void drawPixel_impl(std::int32_t x, std::int32_t y) = 0;
+    virtual void drawPixels_impl(const point_t* points, const std::uint32_t* rawcolors, std::uint32_t count); // rawcolors : nullptr = current color
     virtual void writeFillRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) = 0;
+    virtual void writeAlphaSpan_impl(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* alpha); // blend _smooth_rgb888 by alpha (0-255). pre-clipped.
     virtual void copyRect_impl(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y) = 0;
     virtual void readRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, void* dst, pixelcopy_t* param) = 0;
     virtual void pushImage_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t* param, bool use_dma) = 0;
@@ -522,6 +775,9 @@ namespace lgfx
     virtual bool isReadable_impl(void) const = 0;
     virtual std::int_fast8_t getRotation_impl(void) const = 0;
 
+    // move the full width rows [y, y+h) by dy without copying. return false if not supported.
+    virtual bool scrollRows_impl(std::int32_t /*y*/, std::int32_t /*h*/, std::int32_t /*dy*/) { return false; }
+
     static void tmpBeginTransaction(void* lgfx) {
       auto me = (LGFXBase*)lgfx;
       if (me->_transaction_count) me->beginTransaction();
@@ -530,13 +786,6 @@ namespace lgfx
       auto me = (LGFXBase*)lgfx;
       if (me->_transaction_count) me->endTransaction();
     }
-    void prepareTmpTransaction(DataWrapper* data) {
-      if (data->need_transaction && isSPIShared()) {
-        data->parent = this;
-        data->fp_pre_read  = tmpEndTransaction;
-        data->fp_post_read = tmpBeginTransaction;
-      }
-    }
     __attribute__ ((always_inline)) inline void startWrite(bool transaction) {
       if (1 == ++_transaction_count && transaction) beginTransaction();
     }
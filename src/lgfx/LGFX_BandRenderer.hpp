@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_BANDRENDERER_HPP_
+#define LGFX_BANDRENDERER_HPP_
+
+#include "LGFX_Sprite.hpp"
+#include "LGFX_DisplayList.hpp"
+
+namespace lgfx
+{
+  // renders a display list band by band through small sprites (e.g. 480x32),
+  // instead of compositing the whole frame in a full size sprite.
+  // each band is cleared to the base colour, the commands outside of it are skipped,
+  // and the band is pushed to the target as one image.
+  // with double buffering, the next band is drawn while the previous one is sent by DMA.
+  // recorded copyRect only sees the pixels of the current band.
+  class LGFX_BandRenderer
+  {
+  public:
+
+    LGFX_BandRenderer(void) {}
+
+    virtual ~LGFX_BandRenderer() {
+      deleteBands();
+    }
+
+    // w x band_h : band size. depth : 8 / 16 / 24 bit, same as the target for direct DMA transfer.
+    bool createBands(std::int32_t w, std::int32_t band_h, color_depth_t depth = rgb565_2Byte, bool double_buffer = true)
+    {
+      deleteBands();
+      _count = double_buffer ? 2 : 1;
+      for (std::uint_fast8_t i = 0; i < _count; ++i) {
+        _band[i].setColorDepth(depth);
+        if (!_band[i].createSprite(w, band_h, 4) || _band[i].hasPalette()) {
+          deleteBands();
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void deleteBands(void)
+    {
+      _band[0].deleteSprite();
+      _band[1].deleteSprite();
+      _count = 0;
+      _index = 0;
+    }
+
+    std::int32_t bandWidth(void) const { return _band[0].width(); }
+    std::int32_t bandHeight(void) const { return _band[0].height(); }
+
+    // background of the bands.
+    template<typename T> __attribute__ ((always_inline)) inline void setBaseColor(T c) { _base_rgb888 = convert_to_rgb888(c); }
+    std::uint32_t getBaseColor(void) const { return _base_rgb888; }
+
+    // draw the list on dst at (x, y). the area outside the clip of dst is not rendered.
+    void render(const LGFX_DisplayList& list, LovyanGFX* dst, std::int32_t x = 0, std::int32_t y = 0)
+    {
+      if (!_count) return;
+      std::int32_t cx, cy, cw, ch;
+      dst->getClipRect(&cx, &cy, &cw, &ch);
+      std::int32_t l = std::max(x, cx);
+      std::int32_t t = std::max(y, cy);
+      std::int32_t r = std::min(x + list.width() , cx + cw);
+      std::int32_t b = std::min(y + list.height(), cy + ch);
+      if (l >= r || t >= b) return;
+
+      auto first = list.begin();
+      auto last = list.end();
+      std::int32_t bw = bandWidth();
+      std::int32_t bh = bandHeight();
+      dst->startWrite();
+      for (std::int32_t by = t; by < b; by += bh) {
+        std::int32_t h = std::min(bh, b - by);
+        for (std::int32_t bx = l; bx < r; bx += bw) {
+          std::int32_t w = std::min(bw, r - bx);
+          auto band = &_band[_index];
+          // the push of this band waits for the transfer of the previous one,
+          // so a band is not redrawn while it is being sent.
+          band->fillScreen(_base_rgb888);
+          band->draw_display_list(first, last, x - bx, y - by, 0, 0, w, h);
+          pixelcopy_t p(band->getBuffer(), dst->getColorDepth(), band->getColorDepth(), dst->hasPalette(), nullptr);
+          dst->push_image(bx, by, w, h, &p, true, band->bufferStride());
+          if (_count > 1) _index ^= 1;
+        }
+      }
+      // the last band may still be in transfer.
+      dst->waitDMA();
+      dst->endWrite();
+    }
+
+  protected:
+    LGFX_Sprite _band[2];
+    std::uint32_t _base_rgb888 = 0;
+    std::uint_fast8_t _count = 0;
+    std::uint_fast8_t _index = 0;
+  };
+
+}
+
+typedef lgfx::LGFX_BandRenderer LGFX_BandRenderer;
+
+#endif
@@ -0,0 +1,103 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_DEVICE_HPP_
+#define LGFX_DEVICE_HPP_
+
+#include "LGFX_PanelProtocol.hpp"
+#include "bus/BusCommon.hpp"
+
+namespace lgfx
+{
+  // LGFX_PanelProtocol on top of a BusCommon, without the register access of the platform.
+  // (8bit command / parameter bus)
+  class LGFX_Device : public LGFX_PanelProtocol<LGFX_Device>
+  {
+    friend LGFX_PanelProtocol<LGFX_Device>;
+  public:
+
+    void setBus(BusCommon* bus) { _bus = bus; }
+    __attribute__ ((always_inline)) inline BusCommon* getBus(void) const { return _bus; }
+
+    void initPanel(void) override
+    {
+      if (!_bus) return;
+      LGFX_PanelProtocol::initPanel();
+    }
+
+//----------------------------------------------------------------------------
+  protected:
+
+    void initBus(void) { _bus->init(); }
+
+    void begin_transaction(void) {
+      _bus->beginTransaction();
+      cs_l();
+    }
+
+    void end_transaction(void) {
+      if (_panel->spi_cs < 0) {
+        write_cmd(0); // NOP command
+      }
+      _bus->wait();
+      cs_h();
+      _bus->endTransaction();
+    }
+
+    __attribute__ ((always_inline)) inline void wait_spi(void) { _bus->wait(); }
+
+    __attribute__ ((always_inline)) inline void write_cmd(std::uint_fast8_t cmd) { _bus->writeCommand(cmd, 8); }
+
+    __attribute__ ((always_inline)) inline void write_data(std::uint32_t data, std::uint32_t bit_length) { _bus->writeData(data, bit_length); }
+
+    __attribute__ ((always_inline)) inline void write_bytes(const std::uint8_t* data, std::int32_t length, bool use_dma = false) { _bus->writeBytes(data, length, use_dma); }
+
+    void push_block(std::int32_t length, bool = false)
+    {
+      if (length == 1) { write_data(_color.raw, _write_conv.bits); return; }
+      _bus->writeDataRepeat(_color.raw, _write_conv.bits, length);
+    }
+
+    void start_read(void) {
+      _bus->beginRead();
+    }
+
+    void end_read(void)
+    {
+      _bus->endRead();
+      cs_h();
+      if (_panel->spi_cs < 0) {
+        write_cmd(0); // NOP command
+      }
+      cs_l();
+    }
+
+    __attribute__ ((always_inline)) inline std::uint32_t read_data(std::uint32_t bit_length) { return _bus->readData(bit_length); }
+
+    __attribute__ ((always_inline)) inline void read_bytes(std::uint8_t* dst, std::int32_t length) { _bus->readBytes(dst, length); }
+
+    BusCommon* _bus = nullptr;
+  };
+
+//----------------------------------------------------------------------------
+}
+
+typedef lgfx::LGFX_Device LGFX_Device;
+
+#endif
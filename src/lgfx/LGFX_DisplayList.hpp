@@ -0,0 +1,414 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_DISPLAYLIST_HPP_
+#define LGFX_DISPLAYLIST_HPP_
+
+#include <algorithm>
+
+#include "LGFXBase.hpp"
+
+namespace lgfx
+{
+  // recorder target. the draw calls are captured as commands with their bounding box,
+  // and replayed on any target with replay() (commands outside its clip are skipped).
+  // primitives and text are kept as rects and coverage spans, images as bgr888 pixels.
+  // flood fill and readback are not supported (the recorder has no pixels).
+  class LGFX_DisplayList : public LovyanGFX
+  {
+  public:
+
+    typedef display_command_t command_t;
+
+    LGFX_DisplayList(void)
+    : LovyanGFX()
+    {
+      _write_conv.setColorDepth(rgb888_3Byte);
+      _read_conv = _write_conv;
+      _spi_shared = false;
+      _transaction_count = 0xFFFF;
+      clear_tile();
+    }
+
+    virtual ~LGFX_DisplayList() {
+      deleteDisplayList();
+    }
+
+    // the drawing area. commands are clipped to it.
+    bool createDisplayList(std::int32_t w, std::int32_t h)
+    {
+      deleteDisplayList();
+      if (w < 1 || h < 1 || w > INT16_MAX || h > INT16_MAX) return false;
+
+      _sw = _width = w;
+      _clip_r = w - 1;
+      _xpivot = w >> 1;
+
+      _sh = _height = h;
+      _clip_b = h - 1;
+      _ypivot = h >> 1;
+
+      _clip_l = _clip_t = _sx = _sy = 0;
+      set_window(0, 0, w - 1, h - 1);
+      return true;
+    }
+
+    void deleteDisplayList(void)
+    {
+      clear();
+      if (_buf) { heap_free(_buf); _buf = nullptr; }
+      if (_line) { heap_free(_line); _line = nullptr; }
+      _cap = _line_cap = 0;
+      _width = 0;
+      _height = 0;
+      _clip_l = 0;
+      _clip_t = 0;
+      _clip_r = -1;
+      _clip_b = -1;
+      _sw = 0;
+      _sh = 0;
+    }
+
+    // drop the commands. the buffer is kept for the next recording.
+    void clear(void)
+    {
+      _len = 0;
+      _count = 0;
+      _last = ~0u;
+      _last_rgb = ~0u;
+      clear_tile();
+    }
+
+    // true : image pushes keep a reference to the source pixels instead of a copy.
+    // the source must stay unchanged until the list is cleared. images drawn by the library
+    // from temporary buffers (gradients, decoders, some fonts) must not be recorded in this mode.
+    // 1-bit bitmaps are always recorded as pixels.
+    void setImageReference(bool enabled) { _image_ref = enabled; }
+
+    std::uint32_t commandCount(void) const { flush(); return _count; }
+    std::uint32_t bufferLength(void) const { flush(); return _len * sizeof(std::uint32_t); } // bytes in use
+    const command_t* begin(void) const { flush(); return (const command_t*)_buf; }
+    const command_t* end(void) const { flush(); return (const command_t*)(_buf + _len); }
+
+    // draw the commands on dst at (x, y). the clip of dst (and the clip rect) limits the output.
+    void replay(LovyanGFX* dst, std::int32_t x = 0, std::int32_t y = 0) const { dst->draw_display_list(begin(), end(), x, y); }
+    void replay(LovyanGFX* dst, std::int32_t x, std::int32_t y, std::int32_t clip_x, std::int32_t clip_y, std::int32_t clip_w, std::int32_t clip_h) const { dst->draw_display_list(begin(), end(), x, y, clip_x, clip_y, clip_w, clip_h); }
+
+//----------------------------------------------------------------------------
+
+  protected:
+    static constexpr std::uint32_t header_words = sizeof(command_t) / sizeof(std::uint32_t);
+
+    std::uint32_t* _buf = nullptr;
+    std::uint32_t _cap = 0;           // words
+    std::uint32_t _len = 0;           // words in use
+    std::uint32_t _count = 0;
+    std::uint32_t _last = ~0u;        // offset of the last command
+    std::uint32_t _last_rgb = ~0u;    // colour of the last op_fill with a colour (~0 : none)
+    bgr888_t* _line = nullptr;        // one row of converted pixels
+    std::uint32_t _line_cap = 0;
+    std::int32_t _xptr = 0;
+    std::int32_t _yptr = 0;
+    std::int32_t _xs = 0;
+    std::int32_t _xe = 0;
+    std::int32_t _ys = 0;
+    std::int32_t _ye = 0;
+    bool _image_ref = false;
+
+    // coverage spans are gathered in one tile cell and written out as one op_alpha.
+    static constexpr std::int32_t tile_w = 32, tile_h = 16;
+    std::uint8_t _tile[tile_h][tile_w];
+    std::int8_t _row_l[tile_h];                   // touched columns of each row (l > r : none)
+    std::int8_t _row_r[tile_h];
+    std::int32_t _tile_x = 0, _tile_y = 0;        // cell origin
+    std::int32_t _tile_t = tile_h, _tile_b = -1;  // touched rows (t > b : empty)
+    std::uint32_t _tile_rgb = 0;
+
+    void flush(void) const { const_cast<LGFX_DisplayList*>(this)->flush_alpha(); }
+
+    void clear_tile(void)
+    {
+      memset(_tile, 0, sizeof(_tile));
+      memset(_row_l, tile_w, sizeof(_row_l));
+      memset(_row_r, -1, sizeof(_row_r));
+      _tile_t = tile_h;
+      _tile_b = -1;
+    }
+
+    // payload : rgb888, then for each row of the bounding box : column offset, length, alpha bytes.
+    void flush_alpha(void)
+    {
+      if (_tile_t > _tile_b) return;
+      std::int32_t t = _tile_t, b = _tile_b;
+      std::int32_t l = tile_w, r = -1;
+      std::uint32_t bytes = 0;
+      for (std::int32_t y = t; y <= b; ++y) {
+        bytes += 2;
+        if (_row_l[y] > _row_r[y]) continue;
+        bytes += _row_r[y] - _row_l[y] + 1;
+        if (l > _row_l[y]) l = _row_l[y];
+        if (r < _row_r[y]) r = _row_r[y];
+      }
+      std::uint32_t words = (bytes + 3) >> 2;
+      auto p = add(command_t::op_alpha, _tile_x + l, _tile_y + t, _tile_x + r, _tile_y + b, 1 + words);
+      if (p) {
+        p[0] = _tile_rgb;
+        p[words] = 0;
+        auto dst = (std::uint8_t*)&p[1];
+        for (std::int32_t y = t; y <= b; ++y) {
+          std::int32_t len = _row_r[y] - _row_l[y] + 1;
+          if (len < 0) len = 0;
+          dst[0] = len ? _row_l[y] - l : 0;
+          dst[1] = len;
+          memcpy(&dst[2], &_tile[y][_row_l[y] & (tile_w - 1)], len);
+          dst += 2 + len;
+        }
+      }
+      clear_tile();
+    }
+
+    // a span within one cell.
+    void add_alpha(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* alpha)
+    {
+      std::int32_t cx = x & ~(tile_w - 1);
+      std::int32_t cy = y & ~(tile_h - 1);
+      if (_tile_t <= _tile_b) {
+        bool same = cx == _tile_x && cy == _tile_y && _tile_rgb == _smooth_rgb888;
+        // a pixel covered twice is blended twice, it starts a new command.
+        for (std::int32_t i = 0; same && i < w; ++i) same = !_tile[y - cy][x - cx + i];
+        if (!same) flush_alpha();
+      }
+      _tile_x = cx;
+      _tile_y = cy;
+      _tile_rgb = _smooth_rgb888;
+      x -= cx;
+      y -= cy;
+      memcpy(&_tile[y][x], alpha, w);
+      if (_row_l[y] > x) _row_l[y] = x;
+      if (_row_r[y] < x + w - 1) _row_r[y] = x + w - 1;
+      if (_tile_t > y) _tile_t = y;
+      if (_tile_b < y) _tile_b = y;
+    }
+
+    command_t* last(command_t::op_t op)
+    {
+      flush_alpha();
+      if (_last == ~0u) return nullptr;
+      auto c = (command_t*)&_buf[_last];
+      return (c->op() == op) ? c : nullptr;
+    }
+
+    // out of memory : nullptr, the command is dropped.
+    std::uint32_t* add(command_t::op_t op, std::int32_t l, std::int32_t t, std::int32_t r, std::int32_t b, std::uint32_t words)
+    {
+      if (op != command_t::op_alpha) flush_alpha();
+      std::uint32_t n = header_words + words;
+      if (!heap_reserve(_buf, _cap, _len + n, 64)) return nullptr;
+      auto c = (command_t*)&_buf[_len];
+      c->head = op | n << 8;
+      c->l = l;
+      c->t = t;
+      c->r = r;
+      c->b = b;
+      _last = _len;
+      _len += n;
+      ++_count;
+      return (std::uint32_t*)(c + 1);
+    }
+
+    // grow the last command by one row of payload.
+    std::uint32_t* extend(command_t* c, std::uint32_t words)
+    {
+      std::uint32_t pos = _last;
+      if (!heap_reserve(_buf, _cap, _len + words, 64)) return nullptr;
+      c = (command_t*)&_buf[pos];
+      c->head += words << 8;
+      c->b++;
+      auto res = &_buf[_len];
+      _len += words;
+      return res;
+    }
+
+    // bgr888 run on row y. stacked runs of the same columns are merged into one command.
+    void add_pixels(std::int32_t x, std::int32_t y, std::int32_t w, const bgr888_t* src)
+    {
+      std::uint32_t words = (w * 3 + 3) >> 2;
+      std::uint32_t* p;
+      auto c = last(command_t::op_pixels);
+      if (c && c->l == x && c->r == x + w - 1 && c->b == y - 1) p = extend(c, words);
+      else p = add(command_t::op_pixels, x, y, x + w - 1, y, words);
+      if (p == nullptr) return;
+      p[words - 1] = 0;
+      memcpy(p, src, w * 3);
+    }
+
+    // converts one row through the pixelcopy, transparent pixels are left out.
+    static bool is_bitmap(const pixelcopy_t* param)
+    {
+      return param->fp_copy == pixelcopy_t::bitmapcopy<1>
+          || param->fp_copy == pixelcopy_t::bitmapcopy<2>
+          || param->fp_copy == pixelcopy_t::bitmapcopy<3>;
+    }
+
+    void add_row(std::int32_t x, std::int32_t y, std::int32_t w, pixelcopy_t* param)
+    {
+      if (!heap_reserve(_line, _line_cap, w, 64)) return;
+      std::int32_t pos = 0;
+      for (;;) {
+        std::int32_t end = param->fp_copy(_line, pos, w, param);
+        if (end > pos) add_pixels(x + pos, y, end - pos, &_line[pos]);
+        if (end >= w || param->fp_skip == nullptr) break;
+        pos = param->fp_skip(end, w, param);
+        if (pos >= w) break;
+      }
+    }
+
+    void set_window(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye)
+    {
+      if (xs > xe) std::swap(xs, xe);
+      if (ys > ye) std::swap(ys, ye);
+      if ((xe < 0) || (ye < 0) || (xs >= _width) || (ys >= _height))
+      {
+        _xptr = _xs = _xe = 0;
+        _yptr = _ys = _ye = _height;
+      } else {
+        _xptr = _xs = (xs < 0) ? 0 : xs;
+        _yptr = _ys = (ys < 0) ? 0 : ys;
+        _xe = std::min(xe, _width  - 1);
+        _ye = std::min(ye, _height - 1);
+      }
+    }
+
+    inline void ptr_advance(std::int32_t length = 1) {
+      if ((_xptr += length) > _xe) {
+        _xptr = _xs;
+        if (++_yptr > _ye) {
+          _yptr = _ys;
+        }
+      }
+    }
+
+    void setWindow_impl(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye) override
+    {
+      set_window(xs, ys, xe, ye);
+    }
+
+    void drawPixel_impl(std::int32_t x, std::int32_t y) override
+    {
+      writeFillRect_impl(x, y, 1, 1);
+    }
+
+    void writeFillRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) override
+    {
+      std::uint32_t rgb = getSwap24(_color.raw & 0xFFFFFF);
+      bool change = (rgb != _last_rgb);
+      if (!change) {
+        auto c = last(command_t::op_fill);
+        if (c && c->l == x && c->r == x + w - 1 && c->b == y - 1) {
+          c->b = y + h - 1;
+          return;
+        }
+      }
+      auto p = add(command_t::op_fill, x, y, x + w - 1, y + h - 1, change ? 1 : 0);
+      if (p && change) {
+        *p = rgb;
+        _last_rgb = rgb;
+      }
+    }
+
+    void writeAlphaSpan_impl(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* alpha) override
+    {
+      std::int32_t len;
+      do {
+        len = std::min(w, tile_w - (x & (tile_w - 1)));
+        add_alpha(x, y, len, alpha);
+        x += len;
+        alpha += len;
+      } while (w -= len);
+    }
+
+    void pushBlock_impl(std::int32_t length) override
+    {
+      if (_yptr >= _height) return;
+      std::int32_t ll;
+      do {
+        ll = std::min(_xe - _xptr + 1, length);
+        writeFillRect_impl(_xptr, _yptr, ll, 1);
+        ptr_advance(ll);
+      } while (length -= ll);
+    }
+
+    void pushImage_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t* param, bool) override
+    {
+      // drawBitmap / drawXBitmap expand through a table on the caller's stack : always recorded as pixels.
+      if (_image_ref && !is_bitmap(param)) {
+        auto p = add(command_t::op_image, x, y, x + w - 1, y + h - 1, (sizeof(pixelcopy_t) + 3) >> 2);
+        if (p) memcpy(p, param, sizeof(pixelcopy_t));
+        return;
+      }
+      auto sx = param->src_x;
+      do {
+        add_row(x, y++, w, param);
+        param->src_x = sx;
+        param->src_y++;
+      } while (--h);
+    }
+
+    void pushColors_impl(std::int32_t length, pixelcopy_t* param) override
+    {
+      if (_yptr >= _height) return;
+      std::int32_t linelength;
+      do {
+        linelength = std::min(_xe - _xptr + 1, length);
+        add_row(_xptr, _yptr, linelength, param);
+        ptr_advance(linelength);
+      } while (length -= linelength);
+    }
+
+    void copyRect_impl(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y) override
+    {
+      auto p = add(command_t::op_copy, dst_x, dst_y, dst_x + w - 1, dst_y + h - 1, 1);
+      if (p) *p = (std::uint16_t)src_x | (std::uint32_t)src_y << 16;
+    }
+
+    // no pixels to read. black is returned.
+    void readRect_impl(std::int32_t, std::int32_t, std::int32_t w, std::int32_t h, void* dst, pixelcopy_t* param) override
+    {
+      static const bgr888_t black[1] = {};
+      param->src_data = black;
+      param->src_x32 = param->src_y32 = 0;
+      param->src_x32_add = param->src_y32_add = 0;
+      param->fp_copy(dst, 0, w * h, param);
+    }
+
+    void paint_impl(std::int32_t, std::int32_t) override {}
+
+    void beginTransaction_impl(void) override {}
+    void endTransaction_impl(void) override {}
+    void waitDMA_impl(void) override {}
+
+    bool isReadable_impl(void) const override { return false; }
+    std::int_fast8_t getRotation_impl(void) const override { return 0; }
+  };
+
+}
+
+typedef lgfx::LGFX_DisplayList LGFX_DisplayList;
+
+#endif
@@ -0,0 +1,158 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_FRAMEBUFFER_HPP_
+#define LGFX_FRAMEBUFFER_HPP_
+
+#include "LGFX_Sprite.hpp"
+
+#include <cstdio>
+
+namespace lgfx
+{
+  // display device on a RAM framebuffer. (for the host build, tests and offscreen rendering)
+  // the frame is exposed by getBuffer() / bufferStride() / bufferLength(), rows top to bottom.
+  class LGFX_Framebuffer : public LGFX_Sprite
+  {
+  public:
+
+    LGFX_Framebuffer(std::int32_t w = 320, std::int32_t h = 240, color_depth_t depth = rgb565_2Byte)
+    : LGFX_Sprite()
+    , _fb_width (w)
+    , _fb_height(h)
+    , _fb_depth (depth)
+    {}
+
+    virtual ~LGFX_Framebuffer() {
+#if defined (LGFX_HOST)
+      closeY4M();
+#endif
+    }
+
+    bool init(void)
+    {
+      // keep the rows in display order, the frame is read as raw memory.
+      setRingBuffer(false);
+      setColorDepth(_fb_depth);
+      return createSprite(_fb_width, _fb_height, 4);
+    }
+
+    bool init(std::int32_t w, std::int32_t h, color_depth_t depth = rgb565_2Byte)
+    {
+      _fb_width  = w;
+      _fb_height = h;
+      _fb_depth  = depth;
+      return init();
+    }
+
+    __attribute__ ((always_inline)) inline bool begin(void) { return init(); }
+
+#if defined (LGFX_HOST)
+
+    // stream frames to a YUV4MPEG2 file (4:4:4, BT.601 limited range). play with ffplay / mpv.
+    bool openY4M(const char* path, std::uint32_t fps = 30)
+    {
+      closeY4M();
+      if (!_img) return false;
+      _y4m_fp = fopen(path, "wb");
+      if (!_y4m_fp) return false;
+      _y4m_width  = _width;
+      _y4m_height = _height;
+      _y4m_buf = (std::uint8_t*)heap_alloc(_y4m_width * (_y4m_height * 3 + 3));
+      if (!_y4m_buf) {
+        closeY4M();
+        return false;
+      }
+      fprintf(_y4m_fp, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", _y4m_width, _y4m_height, fps);
+      _frame_count = 0;
+      return true;
+    }
+
+    void closeY4M(void)
+    {
+      if (_y4m_fp) {
+        fclose(_y4m_fp);
+        _y4m_fp = nullptr;
+      }
+      if (_y4m_buf) {
+        heap_free(_y4m_buf);
+        _y4m_buf = nullptr;
+      }
+    }
+
+    bool isY4MOpen(void) const { return _y4m_fp; }
+
+    // append the current frame. false when the stream is closed or the frame size changed.
+    bool writeY4MFrame(void)
+    {
+      if (!_y4m_fp || _width != _y4m_width || _height != _y4m_height) return false;
+      std::int32_t w = _y4m_width;
+      std::int32_t plane = w * _y4m_height;
+      auto rgb = (bgr888_t*)&_y4m_buf[plane * 3];
+      auto py = _y4m_buf;
+      auto pu = py + plane;
+      auto pv = pu + plane;
+      for (std::int32_t y = 0; y < _y4m_height; ++y) {
+        readRectRGB(0, y, w, 1, rgb);
+        for (std::int32_t x = 0; x < w; ++x) {
+          std::int32_t r = rgb[x].r, g = rgb[x].g, b = rgb[x].b;
+          *py++ = ( 66 * r + 129 * g +  25 * b + 128 + (16 << 8)) >> 8;
+          *pu++ = (-38 * r -  74 * g + 112 * b + 128 + (128 << 8)) >> 8;
+          *pv++ = (112 * r -  94 * g -  18 * b + 128 + (128 << 8)) >> 8;
+        }
+      }
+      if (fwrite("FRAME\n", 1, 6, _y4m_fp) != 6
+       || fwrite(_y4m_buf, 1, plane * 3, _y4m_fp) != (size_t)plane * 3) return false;
+      ++_frame_count;
+      return true;
+    }
+
+    std::uint32_t frameCount(void) const { return _frame_count; }
+
+    // end of a frame. appends it to the Y4M stream if open.
+    void display(void) { if (_y4m_fp) writeY4MFrame(); }
+
+#else
+
+    void display(void) {}
+
+#endif
+
+//----------------------------------------------------------------------------
+
+  protected:
+    std::int32_t _fb_width;
+    std::int32_t _fb_height;
+    color_depth_t _fb_depth;
+
+#if defined (LGFX_HOST)
+    FILE* _y4m_fp = nullptr;
+    std::uint8_t* _y4m_buf = nullptr;  // Y, U, V planes + one RGB row
+    std::int32_t _y4m_width = 0;
+    std::int32_t _y4m_height = 0;
+    std::uint32_t _frame_count = 0;
+#endif
+  };
+
+//----------------------------------------------------------------------------
+}
+
+typedef lgfx::LGFX_Framebuffer LGFX_Framebuffer;
+
+#endif
@@ -0,0 +1,629 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_PANELPROTOCOL_HPP_
+#define LGFX_PANELPROTOCOL_HPP_
+
+#include <algorithm>
+
+#include "LGFXBase.hpp"
+#include "panel/PanelCommon.hpp"
+
+namespace lgfx
+{
+  // the panel protocol (CASET / RASET / RAMWR / RAMRD, scroll zone rows ...) shared by LGFX_SPI and LGFX_Device.
+  // T gives the bus access :
+  //   initBus, begin_transaction, end_transaction, wait_spi, start_read, end_read,
+  //   write_cmd, write_data, write_bytes, push_block, read_data, read_bytes
+  // and may replace the generic ones below by its own fast path :
+  //   write_param, write_addr, end_fill, push_colors, push_image, read_dummy, read_pixels, cs_h, cs_l
+  template <class T>
+  class LGFX_PanelProtocol : public LovyanGFX
+  {
+  public:
+
+    virtual ~LGFX_PanelProtocol() {
+      delete_dmabuffer();
+    }
+
+    void setPanel(PanelCommon* panel) { _panel = panel; self()->postSetPanel(); }
+
+    __attribute__ ((always_inline)) inline PanelCommon* getPanel(void) const { return _panel; }
+
+    __attribute__ ((always_inline)) inline bool getInvert(void) const { return _panel->invert; }
+
+    __attribute__ ((always_inline)) inline void dmaWait(void) { self()->wait_spi(); }
+
+    __attribute__ ((always_inline)) inline void begin(void) { init(); }
+
+    void init(void) { self()->initBus(); initPanel(); }
+
+    // Write single byte as COMMAND
+    void writeCommand(std::uint_fast8_t cmd) { startWrite(); self()->write_cmd(cmd); endWrite(); } // AdafruitGFX compatible
+    void writecommand(std::uint_fast8_t cmd) { startWrite(); self()->write_cmd(cmd); endWrite(); } // TFT_eSPI compatible
+
+    // Write single bytes as DATA
+    void spiWrite( std::uint_fast8_t data) { startWrite(); self()->write_param(data); endWrite(); } // AdafruitGFX compatible
+    void writeData(std::uint_fast8_t data) { startWrite(); self()->write_param(data); endWrite(); } // TFT_eSPI compatible
+    void writedata(std::uint_fast8_t data) { startWrite(); self()->write_param(data); endWrite(); } // TFT_eSPI compatible
+
+    // Read data
+    std::uint8_t  readCommand8( std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return read_command(commandByte, index << 3, 8); }
+    std::uint8_t  readcommand8( std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return read_command(commandByte, index << 3, 8); }
+    std::uint16_t readCommand16(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap16(read_command(commandByte, index << 3, 16)); }
+    std::uint16_t readcommand16(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap16(read_command(commandByte, index << 3, 16)); }
+    std::uint32_t readCommand32(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap32(read_command(commandByte, index << 3, 32)); }
+    std::uint32_t readcommand32(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap32(read_command(commandByte, index << 3, 32)); }
+
+    void setColorDepth(std::uint8_t bpp) { setColorDepth((color_depth_t)bpp); }
+
+    void sleep()  { writeCommand(_panel->getCmdSlpin()); }
+
+    void wakeup() { writeCommand(_panel->getCmdSlpout()); }
+
+    void setColorDepth(color_depth_t depth)
+    {
+      std::uint8_t buf[32];
+      commandList(_panel->getColorDepthCommands(buf, depth));
+      postSetColorDepth();
+    }
+
+    void setRotation(std::int_fast8_t r)
+    {
+      vscroll_reset();
+      std::uint8_t buf[32];
+      commandList(_panel->getRotationCommands(buf, r));
+      postSetRotation();
+    }
+
+    void invertDisplay(bool i)
+    {
+      std::uint8_t buf[32];
+      commandList(_panel->getInvertDisplayCommands(buf, i));
+    }
+
+    void setBrightness(std::uint8_t brightness) {
+      _panel->setBrightness(brightness);
+    }
+
+    std::uint32_t readPanelID(void)
+    {
+      return read_command(_panel->getCmdRddid(), _panel->len_dummy_read_rddid, 32);
+    }
+
+    virtual void initPanel(void)
+    {
+      if (!_panel) return;
+
+      _panel->init();
+      _vscroll = vscroll_rows_t();
+
+      startWrite();
+
+      const std::uint8_t *cmds;
+      for (std::uint8_t i = 0; (cmds = _panel->getInitCommands(i)); i++) {
+        delay(120);
+        self()->cs_l();
+        commandList(cmds);
+        self()->wait_spi();
+        self()->cs_h();
+      }
+      self()->cs_l();
+
+      invertDisplay(getInvert());
+      setColorDepth(getColorDepth());
+      setRotation(getRotation());
+      clear();
+
+      endWrite();
+
+      _sx = _sy = 0;
+      _sw = _width;
+      _sh = _height;
+    }
+
+    void pushPixelsDMA(const void* data, std::uint32_t length) {
+      self()->write_bytes((const std::uint8_t*)data, length, true);
+    }
+
+//----------------------------------------------------------------------------
+  protected:
+
+    __attribute__ ((always_inline)) inline T* self(void) { return static_cast<T*>(this); }
+
+    bool isReadable_impl(void) const override { return _panel->spi_read; }
+    std::int_fast8_t getRotation_impl(void) const override { return _panel->rotation; }
+
+    void postSetPanel(void)
+    {
+      _cmd_ramwr      = _panel->getCmdRamwr();
+      _len_setwindow  = _panel->len_setwindow;
+      fpGetWindowAddr = _len_setwindow == 32 ? PanelCommon::getWindowAddr32 : PanelCommon::getWindowAddr16;
+
+      if (_panel->spi_cs >= 0) {
+        self()->cs_h();
+        lgfxPinMode(_panel->spi_cs, pin_mode_t::output);
+      }
+
+      postSetRotation();
+      postSetColorDepth();
+    }
+
+    void postSetRotation(void)
+    {
+      bool fullscroll = (_sx == 0 && _sy == 0 && _sw == _width && _sh == _height);
+
+      _cmd_caset = _panel->getCmdCaset();
+      _cmd_raset = _panel->getCmdRaset();
+      _colstart  = _panel->getColStart();
+      _rowstart  = _panel->getRowStart();
+      _width     = _panel->getWidth();
+      _height    = _panel->getHeight();
+      _clip_r = _width - 1;
+      _clip_b = _height - 1;
+
+      if (fullscroll) {
+        _sw = _width;
+        _sh = _height;
+      }
+      _xs = _xe = _ys = _ye = ~0;
+      _clip_l = _clip_t = 0;
+    }
+
+    void postSetColorDepth(void)
+    {
+      _write_conv.setColorDepth(_panel->write_depth);
+      _read_conv.setColorDepth(_panel->read_depth);
+    }
+
+    void beginTransaction_impl(void) override {
+      if (_begun_tr) return;
+      _begun_tr = true;
+      self()->begin_transaction();
+    }
+
+    void endTransaction_impl(void) override {
+      if (!_begun_tr) return;
+      _begun_tr = false;
+      self()->end_transaction();
+    }
+
+    void waitDMA_impl(void) override
+    {
+      self()->wait_spi();
+    }
+
+    void setWindow_impl(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye) override
+    {
+      self()->end_fill();
+      // a window over the wrap of the scroll zone is written in parts. (see pushBlock_impl / pushColors_impl)
+      std::int32_t n = _vscroll.run(ys, ye - ys + 1);
+      set_window(xs, ys, xe, ys + n - 1);
+      self()->write_cmd(_cmd_ramwr);
+      _win_split = (ys + n <= ye);
+      if (_win_split) {
+        _win_xs = xs;
+        _win_ys = ys;
+        _win_xe = xe;
+        _win_ye = ye;
+        _win_next = ys + n;
+        _win_left = (xe - xs + 1) * n;
+      }
+    }
+
+    // set the window to the next part of a split window.
+    void next_window_part(void)
+    {
+      std::int32_t y = (_win_next > _win_ye) ? _win_ys : _win_next;
+      std::int32_t n = _vscroll.run(y, _win_ye - y + 1);
+      set_window(_win_xs, y, _win_xe, y + n - 1);
+      self()->write_cmd(_cmd_ramwr);
+      _win_next = y + n;
+      _win_left = (_win_xe - _win_xs + 1) * n;
+    }
+
+    // full width scroll by the start line of the panel. the rows are remapped in set_window.
+    bool scrollRows_impl(std::int32_t y, std::int32_t h, std::int32_t dy) override
+    {
+      if (_vscroll.offset && (_vscroll.top != y || _vscroll.height != h)) return false; // another zone is scrolled
+      std::int32_t offset = (_vscroll.offset - dy) % h;
+      if (offset < 0) offset += h;
+      std::uint8_t buf[32];
+      if (!commandList(_panel->getVScrollCommands(buf, y, h, offset))) return false;
+      _vscroll.top = y;
+      _vscroll.height = h;
+      _vscroll.offset = offset;
+      return true;
+    }
+
+    void vscroll_reset(void)
+    {
+      if (!_vscroll.offset) return;
+      std::uint8_t buf[32];
+      commandList(_panel->getVScrollCommands(buf, _vscroll.top, _vscroll.height, 0));
+      _vscroll = vscroll_rows_t();
+    }
+
+    void drawPixel_impl(std::int32_t x, std::int32_t y) override
+    {
+      if (_begun_tr) {
+        self()->end_fill();
+        set_window(x, y, x, y);
+        self()->write_cmd(_cmd_ramwr);
+        self()->write_data(_color.raw, _write_conv.bits);
+        return;
+      }
+
+      self()->begin_transaction();
+      set_window(x, y, x, y);
+      self()->write_cmd(_cmd_ramwr);
+      self()->write_data(_color.raw, _write_conv.bits);
+      self()->end_transaction();
+    }
+
+    void writeFillRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) override
+    {
+      std::int32_t n = _vscroll.run(y, h);
+      if (n < h) {
+        writeFillRect_impl(x, y    , w,     n);
+        writeFillRect_impl(x, y + n, w, h - n);
+        return;
+      }
+      self()->end_fill();
+      set_window(x, y, x+w-1, y+h-1);
+      self()->write_cmd(_cmd_ramwr);
+      self()->push_block(w*h, true);
+    }
+
+    void pushBlock_impl(std::int32_t length) override
+    {
+      if (_win_split) {
+        while (length > _win_left) {
+          if (_win_left) {
+            self()->push_block(_win_left);
+            length -= _win_left;
+          }
+          next_window_part();
+        }
+        _win_left -= length;
+      }
+      self()->push_block(length);
+    }
+
+    bool commandList(const std::uint8_t *addr)
+    {
+      if (addr == nullptr) return false;
+      std::uint8_t  cmd;
+      std::uint8_t  numArgs;
+      std::uint8_t  ms;
+
+      self()->end_fill();
+      startWrite();
+      for (;;) {                // For each command...
+        cmd     = *addr++;  // Read, issue command
+        numArgs = *addr++;  // Number of args to follow
+        if (0xFF == (cmd & numArgs)) break;
+        self()->write_cmd(cmd);
+        ms = numArgs & CMD_INIT_DELAY;       // If hibit set, delay follows args
+        numArgs &= ~CMD_INIT_DELAY;          // Mask out delay bit
+
+        while (numArgs--) {                   // For each argument...
+          self()->write_param(*addr++);  // Read, issue argument
+        }
+        if (ms) {
+          ms = *addr++;        // Read post-command delay time (ms)
+          delay( (ms==255 ? 500 : ms) );
+        }
+      }
+      endWrite();
+      return true;
+    }
+
+    void set_window(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
+    {
+      if (_vscroll.offset) {  // rows of the scroll zone, the window must not cross the wrap.
+        std::uint_fast16_t row = _vscroll.row(ys);
+        ye += row - ys;
+        ys = row;
+      }
+      if (_xs != xs || _xe != xe) {
+        self()->write_cmd(_cmd_caset);
+        _xs = xs;
+        _xe = xe;
+        self()->write_addr(fpGetWindowAddr(xs + _colstart, xe + _colstart));
+      }
+      if (_ys != ys || _ye != ye) {
+        self()->write_cmd(_cmd_raset);
+        _ys = ys;
+        _ye = ye;
+        self()->write_addr(fpGetWindowAddr(ys + _rowstart, ye + _rowstart));
+      }
+    }
+
+    // command parameter byte.
+    void write_param(std::uint_fast8_t data) { self()->write_data(data, 8); }
+
+    // CASET / RASET parameters.
+    void write_addr(std::uint32_t addr) { self()->write_data(addr, _len_setwindow); }
+
+    // back to the write clock after a fill.
+    void end_fill(void) {}
+
+    void read_dummy(std::uint32_t bitlen) { self()->read_data(bitlen); }
+
+    std::uint32_t read_command(std::uint_fast8_t command, std::uint32_t bitindex = 0, std::uint32_t bitlen = 8)
+    {
+      startWrite();
+      self()->write_cmd(command);
+      self()->start_read();
+      if (bitindex) self()->read_data(bitindex);
+      std::uint32_t res = self()->read_data(bitlen);
+      self()->end_read();
+      endWrite();
+      return res;
+    }
+
+    void pushImage_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t* param, bool use_dma) override
+    {
+      std::int32_t n = _vscroll.run(y, h);
+      if (n < h) {
+        auto sx = param->src_x;
+        auto sy = param->src_y;
+        pushImage_impl(x, y, w, n, param, use_dma);
+        param->src_x = sx;
+        param->src_y = sy + n;
+        pushImage_impl(x, y + n, w, h - n, param, use_dma);
+        return;
+      }
+      self()->push_image(x, y, w, h, param, use_dma);
+    }
+
+    void push_image(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t* param, bool use_dma)
+    {
+      auto bytes = _write_conv.bytes;
+      auto src_x = param->src_x;
+      auto fp_copy = param->fp_copy;
+
+      std::int32_t xr = (x + w) - 1;
+      if (param->transp == ~0u) {
+        setWindow_impl(x, y, xr, y + h - 1);
+        if (param->no_convert) {
+          std::uint32_t i = src_x * bytes + param->src_y * param->src_stride;
+          auto src = &((const std::uint8_t*)param->src_data)[i];
+          if ((std::int32_t)param->src_stride == w * bytes || h == 1) {
+            self()->write_bytes(src, w * h * bytes, use_dma);
+          } else {
+            auto add = param->src_stride;
+            do {
+              self()->write_bytes(src, w * bytes, use_dma);
+              src += add;
+            } while (--h);
+          }
+        } else
+        if (use_dma) {
+          do {
+            auto buf = get_dmabuffer(w * bytes);
+            fp_copy(buf, 0, w, param);
+            self()->write_bytes(buf, w * bytes, true);
+            param->src_x = src_x;
+            param->src_y++;
+          } while (--h);
+        } else {
+          do {
+            self()->push_colors(w, param);
+            param->src_x = src_x;
+            param->src_y++;
+          } while (--h);
+        }
+      } else {
+        auto fp_skip = param->fp_skip;
+        h += y;
+        do {
+          std::int32_t i = 0;
+          while (w != (i = fp_skip(i, w, param))) {
+            auto buf = get_dmabuffer(w * bytes);
+            std::int32_t len = fp_copy(buf, 0, w - i, param);
+            setWindow_impl(x + i, y, x + i + len - 1, y);
+            self()->write_bytes(buf, len * bytes, true);
+            if (w == (i += len)) break;
+          }
+          param->src_x = src_x;
+          param->src_y++;
+        } while (++y != h);
+      }
+    }
+
+    void pushColors_impl(std::int32_t length, pixelcopy_t* param) override
+    {
+      if (_win_split) {
+        while (length > _win_left) {
+          if (_win_left) {
+            self()->push_colors(_win_left, param);
+            length -= _win_left;
+          }
+          next_window_part();
+        }
+        _win_left -= length;
+      }
+      self()->push_colors(length, param);
+    }
+
+    void push_colors(std::int32_t length, pixelcopy_t* param)
+    {
+      const std::uint32_t bytes = _write_conv.bytes;
+      const std::int32_t limit = 256;
+      do {
+        std::int32_t len = std::min(length, limit);
+        auto buf = get_dmabuffer(len * bytes);
+        param->fp_copy(buf, 0, len, param);
+        self()->write_bytes(buf, len * bytes, true);
+        length -= len;
+      } while (length);
+    }
+
+    void readRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, void* dst, pixelcopy_t* param) override
+    {
+      std::int32_t n = _vscroll.run(y, h);
+      if (n < h) {
+        readRect_impl(x, y, w, n, dst, param);
+        readRect_impl(x, y + n, w, h - n, &((std::uint8_t*)dst)[(n * w * param->dst_bits) >> 3], param);
+        return;
+      }
+      set_window(x, y, x + w - 1, y + h - 1);
+      auto len = w * h;
+      if (!_panel->spi_read) {
+        memset(dst, 0, len * _read_conv.bytes);
+        return;
+      }
+      self()->write_cmd(_panel->getCmdRamrd());
+      std::uint32_t len_dummy_read_pixel = _panel->len_dummy_read_pixel;
+      self()->start_read();
+      if (len_dummy_read_pixel) {
+        self()->read_dummy(len_dummy_read_pixel);
+      }
+
+      if (param->no_convert) {
+        self()->read_bytes((std::uint8_t*)dst, len * _read_conv.bytes);
+      } else {
+        self()->read_pixels(dst, len, param);
+      }
+      self()->end_read();
+    }
+
+    void read_pixels(void* dst, std::int32_t length, pixelcopy_t* param)
+    {
+      const std::uint32_t bytes = _read_conv.bytes;
+      const std::int32_t limit = 32;
+      std::uint8_t buf[limit * 4];  // not get_dmabuffer, copyRect reads into it.
+      std::int32_t dstindex = 0;
+      do {
+        std::int32_t len = std::min(length, limit);
+        self()->read_bytes(buf, len * bytes);
+        param->src_data = buf;
+        param->src_x = 0;
+        dstindex = param->fp_copy(dst, dstindex, dstindex + len, param);
+        length -= len;
+      } while (length);
+    }
+
+    void copyRect_impl(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y) override
+    {
+      std::int32_t n = std::min(_vscroll.run(src_y, h), _vscroll.run(dst_y, h));
+      if (n < h) {  // the parts are copied in the order of the overlap.
+        if (src_y < dst_y) {
+          copyRect_impl(dst_x, dst_y + n, w, h - n, src_x, src_y + n);
+          copyRect_impl(dst_x, dst_y    , w,     n, src_x, src_y    );
+        } else {
+          copyRect_impl(dst_x, dst_y    , w,     n, src_x, src_y    );
+          copyRect_impl(dst_x, dst_y + n, w, h - n, src_x, src_y + n);
+        }
+        return;
+      }
+      pixelcopy_t p((void*)nullptr, _write_conv.depth, _read_conv.depth);
+      if (w < h) {
+        const std::uint32_t buflen = h * _write_conv.bytes;
+        std::int32_t add = (src_x < dst_x) ?   - 1 : 1;
+        std::int32_t pos = (src_x < dst_x) ? w - 1 : 0;
+        do {
+          auto buf = get_dmabuffer(buflen);
+          readRect_impl(src_x + pos, src_y, 1, h, buf, &p);
+          setWindow_impl(dst_x + pos, dst_y, dst_x + pos, dst_y + h - 1);
+          self()->write_bytes(buf, buflen, true);
+          pos += add;
+        } while (--w);
+      } else {
+        const std::uint32_t buflen = w * _write_conv.bytes;
+        std::int32_t add = (src_y < dst_y) ?   - 1 : 1;
+        std::int32_t pos = (src_y < dst_y) ? h - 1 : 0;
+        do {
+          auto buf = get_dmabuffer(buflen);
+          readRect_impl(src_x, src_y + pos, w, 1, buf, &p);
+          setWindow_impl(dst_x, dst_y + pos, dst_x + w - 1, dst_y + pos);
+          self()->write_bytes(buf, buflen, true);
+          pos += add;
+        } while (--h);
+      }
+    }
+
+    struct _dmabufs_t {
+      std::uint8_t* buffer = nullptr;
+      std::uint32_t length = 0;
+      void free(void) {
+        if (buffer) {
+          heap_free(buffer);
+          buffer = nullptr;
+          length = 0;
+        }
+      }
+    };
+
+    // two buffers by turns, one is written while the other is sent by DMA.
+    std::uint8_t* get_dmabuffer(std::uint32_t length)
+    {
+      _dma_flip = !_dma_flip;
+      length = (length + 3) & ~3;
+      if (_dmabufs[_dma_flip].length < length) {
+        _dmabufs[_dma_flip].free();
+        _dmabufs[_dma_flip].buffer = (std::uint8_t*)heap_alloc_dma(length);
+        _dmabufs[_dma_flip].length = _dmabufs[_dma_flip].buffer ? length : 0;
+      }
+      return _dmabufs[_dma_flip].buffer;
+    }
+
+    void delete_dmabuffer(void)
+    {
+      _dmabufs[0].free();
+      _dmabufs[1].free();
+    }
+
+    void cs_h(void) {
+      std::int32_t spi_cs = _panel->spi_cs;
+      if (spi_cs >= 0) gpio_hi(spi_cs);
+    }
+    void cs_l(void) {
+      std::int32_t spi_cs = _panel->spi_cs;
+      if (spi_cs >= 0) gpio_lo(spi_cs);
+    }
+
+    PanelCommon* _panel = nullptr;
+    std::uint32_t(*fpGetWindowAddr)(std::uint_fast16_t, std::uint_fast16_t);
+    std::uint_fast16_t _colstart;
+    std::uint_fast16_t _rowstart;
+    std::uint_fast16_t _xs;
+    std::uint_fast16_t _xe;
+    std::uint_fast16_t _ys;
+    std::uint_fast16_t _ye;
+    vscroll_rows_t _vscroll;
+    std::int32_t _win_xs, _win_ys, _win_xe, _win_ye; // window set by setWindow_impl, when split over the scroll wrap
+    std::int32_t _win_next;  // first row of the next part
+    std::int32_t _win_left;  // pixels left in the current part
+    bool _win_split = false;
+    std::uint32_t _cmd_caset;
+    std::uint32_t _cmd_raset;
+    std::uint32_t _cmd_ramwr;
+    std::uint32_t _len_setwindow;
+    _dmabufs_t _dmabufs[2];
+    bool _begun_tr = false;
+    bool _dma_flip = false;
+  };
+
+//----------------------------------------------------------------------------
+}
+
+#endif
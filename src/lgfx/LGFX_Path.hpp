@@ -0,0 +1,342 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_PATH_HPP_
+#define LGFX_PATH_HPP_
+
+#include <cmath>
+#include <cstring>
+
+#include "lgfx_common.hpp"
+
+namespace lgfx
+{
+  // vector path of lines, quadratic and cubic Bezier curves.
+  // the curves are flattened to polylines within the flatness tolerance (in pixels, after the transform),
+  // the result is kept until the path, the transform or the tolerance changes.
+  // draw it with LovyanGFX::fillPath / drawPath.
+  class LGFX_Path
+  {
+  public:
+    // fraction bits of the flattened points.
+    static constexpr std::uint32_t shift = 4;
+
+    LGFX_Path(void) = default;
+    LGFX_Path(const LGFX_Path&) = delete;
+    LGFX_Path& operator=(const LGFX_Path&) = delete;
+
+    virtual ~LGFX_Path() { release(); }
+
+    // false : out of memory, the command is dropped. (see hasError)
+    bool moveTo(float x, float y)
+    {
+      auto p = add(cmd_move, 1);
+      if (!p) return false;
+      p->set(x, y);
+      return true;
+    }
+    bool lineTo(float x, float y)
+    {
+      auto p = add(cmd_line, 1);
+      if (!p) return false;
+      p->set(x, y);
+      return true;
+    }
+    bool quadTo(float cx, float cy, float x, float y)
+    {
+      auto p = add(cmd_quad, 2);
+      if (!p) return false;
+      p[0].set(cx, cy);
+      p[1].set(x, y);
+      return true;
+    }
+    bool cubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y)
+    {
+      auto p = add(cmd_cubic, 3);
+      if (!p) return false;
+      p[0].set(c1x, c1y);
+      p[1].set(c2x, c2y);
+      p[2].set(x, y);
+      return true;
+    }
+    bool close(void)
+    {
+      std::uint32_t n = _cmd_count;
+      add(cmd_close, 0);  // no coordinates : the result may be null, the count tells
+      return _cmd_count != n;
+    }
+
+    // a command was dropped for lack of memory. the path is not drawn until clear() or release().
+    bool hasError(void) const { return _error; }
+
+    // remove all the commands. the buffers are kept for the next path.
+    void clear(void) { _cmd_count = _coord_count = 0; _error = false; _dirty = true; }
+
+    // release the buffers.
+    void release(void)
+    {
+      if (_cmds  ) { heap_free(_cmds  ); _cmds   = nullptr; }
+      if (_coords) { heap_free(_coords); _coords = nullptr; }
+      if (_points) { heap_free(_points); _points = nullptr; }
+      if (_counts) { heap_free(_counts); _counts = nullptr; }
+      if (_closed) { heap_free(_closed); _closed = nullptr; }
+      _cmd_cap = _coord_cap = _point_cap = _contour_cap = _closed_cap = 0;
+      _cmd_count = _coord_count = _point_count = _contour_count = 0;
+      _error = false;
+      _dirty = true;
+    }
+
+    // x' = a * x + c * y + tx , y' = b * x + d * y + ty
+    void setTransform(float a, float b, float c, float d, float tx, float ty)
+    {
+      float m[6] = { a, b, c, d, tx, ty };
+      if (memcmp(m, _matrix, sizeof(m))) {
+        memcpy(_matrix, m, sizeof(m));
+        _dirty = true;
+      }
+    }
+    void setTranslate(float tx, float ty) { setTransform(1, 0, 0, 1, tx, ty); }
+    void resetTransform(void) { setTransform(1, 0, 0, 1, 0, 0); }
+
+    // max distance between a curve and its polyline in pixels. (default 0.25)
+    void setFlatness(float tolerance)
+    {
+      if (tolerance < 0.01f) tolerance = 0.01f;
+      if (_flatness != tolerance) { _flatness = tolerance; _dirty = true; }
+    }
+    float getFlatness(void) const { return _flatness; }
+
+    // flattened outline in 1/16 pixel units, one polyline per contour.
+    // rebuilt here only when something changed. false : out of memory, now or when the path was built.
+    bool flatten(void) const;
+
+    const point_t* points(void) const { return _points; }
+    const std::uint32_t* counts(void) const { return _counts; }
+    std::uint32_t contours(void) const { return _contour_count; }
+    bool isClosed(std::uint32_t contour) const { return _closed[contour]; }
+
+  protected:
+    enum command_t : std::uint8_t
+    { cmd_move
+    , cmd_line
+    , cmd_quad
+    , cmd_cubic
+    , cmd_close
+    };
+
+    struct coord_t
+    {
+      float x, y;
+      void set(float px, float py) { x = px; y = py; }
+    };
+
+    std::uint8_t* _cmds = nullptr;
+    coord_t* _coords = nullptr;
+    std::uint32_t _cmd_count = 0;
+    std::uint32_t _cmd_cap = 0;
+    std::uint32_t _coord_count = 0;
+    std::uint32_t _coord_cap = 0;
+    float _matrix[6] = { 1, 0, 0, 1, 0, 0 };
+    float _flatness = 0.25f;
+    bool _error = false;
+
+    // flatten cache
+    mutable point_t* _points = nullptr;
+    mutable std::uint32_t* _counts = nullptr;
+    mutable bool* _closed = nullptr;
+    mutable std::uint32_t _point_count = 0;
+    mutable std::uint32_t _point_cap = 0;
+    mutable std::uint32_t _contour_count = 0;
+    mutable std::uint32_t _contour_cap = 0;
+    mutable std::uint32_t _closed_cap = 0;
+    mutable bool _dirty = true;
+
+    // nullptr : out of memory, the command is dropped and the error is kept.
+    coord_t* add(command_t cmd, std::uint32_t coords)
+    {
+      _dirty = true;
+      if (!heap_reserve(_cmds, _cmd_cap, _cmd_count + 1)
+       || !heap_reserve(_coords, _coord_cap, _coord_count + coords)) {
+        _error = true;
+        return nullptr;
+      }
+      _cmds[_cmd_count++] = cmd;
+      auto res = &_coords[_coord_count];
+      _coord_count += coords;
+      return res;
+    }
+
+    coord_t transform(const coord_t& p) const
+    {
+      return { _matrix[0] * p.x + _matrix[2] * p.y + _matrix[4]
+             , _matrix[1] * p.x + _matrix[3] * p.y + _matrix[5] };
+    }
+
+    // start : first point of the contour. repeated points are dropped.
+    bool add_point(float x, float y, std::uint32_t start) const
+    {
+      // keep the products of the polygon filler in range.
+      static constexpr float limit = (float)(1 << 22);
+      x = (x < -limit) ? -limit : (x > limit) ? limit : x;
+      y = (y < -limit) ? -limit : (y > limit) ? limit : y;
+      point_t p = { (std::int32_t)floorf(x * (1 << shift) + 0.5f), (std::int32_t)floorf(y * (1 << shift) + 0.5f) };
+      if (_point_count > start) {
+        auto& last = _points[_point_count - 1];
+        if (last.x == p.x && last.y == p.y) return true;
+      }
+      if (!heap_reserve(_points, _point_cap, _point_count + 1)) return false;
+      _points[_point_count++] = p;
+      return true;
+    }
+
+    // segments for a Bezier curve of the degree, from the largest second difference of the control points. (Wang's formula)
+    std::uint32_t segments(const coord_t* p, std::uint32_t degree) const
+    {
+      float m = 0;
+      for (std::uint32_t i = 0; i + 2 <= degree; ++i) {
+        float dx = p[i].x - 2 * p[i + 1].x + p[i + 2].x;
+        float dy = p[i].y - 2 * p[i + 1].y + p[i + 2].y;
+        float d = dx * dx + dy * dy;
+        if (m < d) m = d;
+      }
+      float n = ceilf(sqrtf(sqrtf(m) * (degree * (degree - 1)) / (8 * _flatness)));
+      return (n < 1) ? 1 : (n > 512) ? 512 : (std::uint32_t)n;
+    }
+  };
+
+  inline bool LGFX_Path::flatten(void) const
+  {
+    if (_error) return false;
+    if (!_dirty) return true;
+    _point_count = _contour_count = 0;
+
+    std::uint32_t start = 0;  // first point of the current contour
+    coord_t first = { 0, 0 }; // untransformed start of the current contour
+    coord_t cur = { 0, 0 };   // untransformed current point
+    bool open = false;    // moveTo seen
+    bool drawn = false;   // a line or a curve is in the contour. a lone moveTo draws nothing.
+    bool closed = false;
+
+    auto end_contour = [&](void) -> bool
+    {
+      if (drawn && _point_count > start) {
+        if (!heap_reserve(_counts, _contour_cap, _contour_count + 1)
+         || !heap_reserve(_closed, _closed_cap, _contour_count + 1)) return false;
+        _closed[_contour_count] = closed;
+        _counts[_contour_count++] = _point_count - start;
+      } else {
+        _point_count = start;
+      }
+      start = _point_count;
+      open = drawn = closed = false;
+      return true;
+    };
+
+    auto begin_contour = [&](const coord_t& p) -> bool
+    {
+      if (open && !end_contour()) return false;
+      first = p;
+      open = true;
+      auto t = transform(p);
+      return add_point(t.x, t.y, start);
+    };
+
+    bool ok = true;
+    auto c = _coords;
+    for (std::uint32_t i = 0; ok && i < _cmd_count; ++i) {
+      switch (_cmds[i]) {
+      case cmd_move:
+        ok = begin_contour(c[0]);
+        cur = c[0];
+        c += 1;
+        break;
+
+      case cmd_line:
+        if (!open) ok = begin_contour(cur);
+        if (ok) {
+          auto t = transform(c[0]);
+          ok = add_point(t.x, t.y, start);
+          drawn = true;
+        }
+        cur = c[0];
+        c += 1;
+        break;
+
+      case cmd_quad:
+      case cmd_cubic:
+        {
+          std::uint32_t degree = _cmds[i] == cmd_quad ? 2 : 3;
+          if (!open) ok = begin_contour(cur);
+          coord_t p[4];
+          p[0] = transform(cur);
+          for (std::uint32_t j = 0; j < degree; ++j) p[j + 1] = transform(c[j]);
+          std::uint32_t n = segments(p, degree);
+          float dt = 1.0f / n;
+          for (std::uint32_t j = 1; ok && j < n; ++j) {
+            float t = j * dt;
+            float u = 1.0f - t;
+            float x, y;
+            if (degree == 2) {
+              x = u * u * p[0].x + 2 * u * t * p[1].x + t * t * p[2].x;
+              y = u * u * p[0].y + 2 * u * t * p[1].y + t * t * p[2].y;
+            } else {
+              float a = u * u * u, b = 3 * u * u * t, d = 3 * u * t * t, e = t * t * t;
+              x = a * p[0].x + b * p[1].x + d * p[2].x + e * p[3].x;
+              y = a * p[0].y + b * p[1].y + d * p[2].y + e * p[3].y;
+            }
+            ok = add_point(x, y, start);
+          }
+          if (ok) ok = add_point(p[degree].x, p[degree].y, start);
+          drawn = true;
+          cur = c[degree - 1];
+          c += degree;
+        }
+        break;
+
+      case cmd_close:
+        if (open) {
+          // drop the end point on the start point, the polyline closes itself.
+          if (_point_count - start > 1) {
+            auto& a = _points[start];
+            auto& b = _points[_point_count - 1];
+            if (a.x == b.x && a.y == b.y) --_point_count;
+          }
+          closed = true;
+          ok = end_contour();
+        }
+        cur = first;
+        break;
+
+      default:
+        break;
+      }
+    }
+    if (ok) ok = end_contour();
+    if (!ok) {
+      _point_count = _contour_count = 0;
+      return false;
+    }
+    _dirty = false;
+    return true;
+  }
+}
+
+typedef lgfx::LGFX_Path LGFX_Path;
+
+#endif
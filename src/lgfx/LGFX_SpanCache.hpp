@@ -0,0 +1,192 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_SPANCACHE_HPP_
+#define LGFX_SPANCACHE_HPP_
+
+#include <cstring>
+
+#include "lgfx_common.hpp"
+
+namespace lgfx
+{
+  // LRU cache of the spans of the fill primitives (fillCircle / fillRoundRect / fillArc).
+  // a shape drawn again with the same size and angles is replayed from its spans with a translation.
+  // set it with LovyanGFX::setSpanCache. a cache may be shared by several targets of one task.
+  class LGFX_SpanCache
+  {
+  public:
+    enum shape_t : std::int32_t
+    { shape_circle = 1  // a : radius
+    , shape_round_rect  // a, b : size, c : radius
+    , shape_arc         // a, b : radius, c : start, d : sweep
+    };
+    struct key_t
+    {
+      std::int32_t shape, a, b, c, d;
+      bool operator==(const key_t& k) const { return shape == k.shape && a == k.a && b == k.b && c == k.c && d == k.d; }
+    };
+    struct span_t { std::int16_t x, y, w, h; };  // relative to the shape origin
+    struct entry_t
+    {
+      key_t key;
+      span_t* spans;
+      std::uint32_t count;
+      std::uint32_t used;          // LRU tick
+      std::int16_t l, t, r, b;     // bounding box, inclusive
+    };
+
+    // entries : number of shapes. max_spans : total spans of all shapes (8 bytes each).
+    LGFX_SpanCache(std::uint32_t entries = 16, std::uint32_t max_spans = 2048)
+    : _capacity(entries), _max_spans(max_spans)
+    {}
+    LGFX_SpanCache(const LGFX_SpanCache&) = delete;
+    LGFX_SpanCache& operator=(const LGFX_SpanCache&) = delete;
+
+    virtual ~LGFX_SpanCache() {
+      clear();
+      if (_entries) heap_free(_entries);
+      if (_rec) heap_free(_rec);
+    }
+
+    // drop the shapes. the statistics are kept.
+    void clear(void)
+    {
+      for (std::uint32_t i = 0; i < _count; ++i) heap_free(_entries[i].spans);
+      _count = 0;
+      _span_total = 0;
+    }
+
+    std::uint32_t hits(void) const { return _hits; }
+    std::uint32_t misses(void) const { return _misses; }
+    std::uint32_t evictions(void) const { return _evictions; }
+    std::uint32_t entryCount(void) const { return _count; }
+    std::uint32_t spanCount(void) const { return _span_total; }
+    void resetStats(void) { _hits = _misses = _evictions = 0; }
+
+//----------------------------------------------------------------------------
+// used by LGFXBase
+
+    // nullptr on a miss.
+    const entry_t* find(const key_t& key)
+    {
+      for (std::uint32_t i = 0; i < _count; ++i) {
+        if (_entries[i].key == key) {
+          ++_hits;
+          _entries[i].used = ++_tick;
+          return &_entries[i];
+        }
+      }
+      ++_misses;
+      return nullptr;
+    }
+
+    // the spans drawn until end_record() are stored for the key.
+    void begin_record(const key_t& key)
+    {
+      _rec_key = key;
+      _rec_count = 0;
+      _rec_fail = false;
+    }
+
+    void record(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
+      if (w < 1 || h < 1 || _rec_fail) return;
+      // vertical runs are merged, the shapes draw the upper and lower halves in turn.
+      std::uint32_t i = _rec_count;
+      std::uint32_t stop = (i > 4) ? i - 4 : 0;
+      while (i-- > stop) {
+        auto s = &_rec[i];
+        if (s->x == x && s->w == w && s->y + s->h == y && s->h + h <= INT16_MAX) { s->h += h; return; }
+        if (s->x == x && s->w == w && y + h == s->y && s->h + h <= INT16_MAX) { s->y = y; s->h += h; return; }
+      }
+      if (x < INT16_MIN || y < INT16_MIN || x + w > INT16_MAX || y + h > INT16_MAX
+       || _rec_count >= _max_spans
+       || !heap_reserve(_rec, _rec_cap, _rec_count + 1, 64)) {
+        _rec_fail = true;
+        return;
+      }
+      _rec[_rec_count++] = { (std::int16_t)x, (std::int16_t)y, (std::int16_t)w, (std::int16_t)h };
+    }
+
+    void end_record(void)
+    {
+      if (_rec_fail || !_rec_count || !_capacity) return;
+      if (!_entries) {
+        _entries = (entry_t*)heap_alloc(_capacity * sizeof(entry_t));
+        if (!_entries) return;
+      }
+      while (_count && (_count == _capacity || _span_total + _rec_count > _max_spans)) evict();
+
+      auto spans = (span_t*)heap_alloc(_rec_count * sizeof(span_t));
+      if (!spans) return;
+      memcpy(spans, _rec, _rec_count * sizeof(span_t));
+      auto e = &_entries[_count++];
+      e->key = _rec_key;
+      e->spans = spans;
+      e->count = _rec_count;
+      e->used = ++_tick;
+      std::int32_t l = INT16_MAX, t = INT16_MAX, r = INT16_MIN, b = INT16_MIN;
+      for (std::uint32_t i = 0; i < _rec_count; ++i) {
+        auto& s = spans[i];
+        if (l > s.x) l = s.x;
+        if (t > s.y) t = s.y;
+        if (r < s.x + s.w - 1) r = s.x + s.w - 1;
+        if (b < s.y + s.h - 1) b = s.y + s.h - 1;
+      }
+      e->l = l; e->t = t; e->r = r; e->b = b;
+      _span_total += _rec_count;
+    }
+
+  protected:
+    entry_t* _entries = nullptr;
+    std::uint32_t _capacity;
+    std::uint32_t _max_spans;
+    std::uint32_t _count = 0;
+    std::uint32_t _span_total = 0;
+    std::uint32_t _tick = 0;
+    std::uint32_t _hits = 0;
+    std::uint32_t _misses = 0;
+    std::uint32_t _evictions = 0;
+
+    span_t* _rec = nullptr;
+    std::uint32_t _rec_cap = 0;
+    std::uint32_t _rec_count = 0;
+    key_t _rec_key;
+    bool _rec_fail = false;
+
+    // remove the least recently used entry.
+    void evict(void)
+    {
+      std::uint32_t idx = 0;
+      for (std::uint32_t i = 1; i < _count; ++i) {
+        if ((std::int32_t)(_entries[i].used - _entries[idx].used) < 0) idx = i;
+      }
+      heap_free(_entries[idx].spans);
+      _span_total -= _entries[idx].count;
+      _entries[idx] = _entries[--_count];
+      ++_evictions;
+    }
+  };
+
+}
+
+typedef lgfx::LGFX_SpanCache LGFX_SpanCache;
+
+#endif
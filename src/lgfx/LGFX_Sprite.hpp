@@ -34,22 +34,23 @@ namespace lgfx
     : LovyanGFX()
     , _parent(parent)
     , _img  (nullptr)
-    , _bitwidth(0)
+    , _stride(0)
     , _xptr (0)
     , _yptr (0)
     , _xs   (0)
     , _xe   (0)
     , _ys   (0)
     , _ye   (0)
-    , _index(0)
     {
       _read_conv = _write_conv;
       _spi_shared = false;
       _transaction_count = 0xFFFF;
     }
 
+    // with setRingBuffer(true), rows of the scroll area may be stored rotated.
     __attribute__ ((always_inline)) inline void* getBuffer(void) const { return _img; }
-    std::uint32_t bufferLength(void) const { return (_bitwidth * _write_conv.bits >> 3) * _height; }
+    std::uint32_t bufferLength(void) const { return _stride * _height; }
+    std::uint32_t bufferStride(void) const { return _stride; }  // bytes per row
 
     LGFX_Sprite()
     : LGFX_Sprite(nullptr)
@@ -70,7 +71,7 @@ namespace lgfx
 
     void deleteSprite(void)
     {
-      _bitwidth = 0;
+      _stride = 0;
       _width = 0;
       _height = 0;
       _clip_l = 0;
@@ -79,11 +80,18 @@ namespace lgfx
       _clip_b = -1;
       _sw = 0;
       _sh = 0;
+      _ring_y = _ring_h = _ring_ofs = 0;
       deletePalette();
-      if (_img != nullptr) {
-        _mem_free(_img);
+      if (_img_mem != nullptr) {
+        _mem_free(_img_mem);
+        _img_mem = nullptr;
         _img = nullptr;
       }
+      if (_quantize_buf != nullptr) {
+        heap_free(_quantize_buf);
+        _quantize_buf = nullptr;
+        _quantize_cap = 0;
+      }
     }
 
     void setPsram( bool enabled )
@@ -91,20 +99,31 @@ namespace lgfx
       _psram = enabled;
     }
 
-    void* createSprite(std::int32_t w, std::int32_t h)
+    // scroll full width areas by rotating a row offset instead of moving the pixels.
+    void setRingBuffer( bool enabled )
     {
-      if (w < 1 || h < 1) return nullptr;
-      if (_img != nullptr) {
-        _mem_free(_img);
+      if (!enabled) ring_normalize();
+      _ring_enable = enabled;
+    }
+
+    // align : row alignment in bytes (power of 2 : 4, 16, 64 ...)
+    void* createSprite(std::int32_t w, std::int32_t h, std::uint32_t align = 1)
+    {
+      if (w < 1 || h < 1 || !align || (align & (align - 1))) return nullptr;
+      if (_img_mem != nullptr) {
+        _mem_free(_img_mem);
+        _img_mem = nullptr;
         _img = nullptr;
       }
-      _bitwidth = (w + _write_conv.x_mask) & (~(std::uint32_t)_write_conv.x_mask);
-      size_t len = (h * _bitwidth * _write_conv.bits >> 3) + 1;
-      _img = (std::uint8_t*)_mem_alloc(len);
-      if (!_img) {
+      std::uint32_t bitwidth = (w + _write_conv.x_mask) & (~(std::uint32_t)_write_conv.x_mask);
+      _stride = ((bitwidth * _write_conv.bits >> 3) + align - 1) & ~(align - 1);
+      size_t len = h * _stride + 1;
+      _img_mem = _mem_alloc(len + align - 1);
+      if (!_img_mem) {
         deleteSprite();
         return nullptr;
       }
+      _img = (std::uint8_t*)(((std::uintptr_t)_img_mem + align - 1) & ~(std::uintptr_t)(align - 1));
       memset(_img, 0, len);
       if (_palette == nullptr && 0 == _write_conv.bytes) createPalette();
 
@@ -116,7 +135,8 @@ namespace lgfx
       _clip_b = _ye = h - 1;
       _ypivot = h >> 1;
 
-      _clip_l = _clip_t = _index = _sx = _sy = _xs = _ys = _xptr = _yptr = 0;
+      _clip_l = _clip_t = _sx = _sy = _xs = _ys = _xptr = _yptr = 0;
+      _ring_y = _ring_h = _ring_ofs = 0;
 
       return _img;
     }
@@ -134,7 +154,7 @@ namespace lgfx
 
  #endif
 
-#elif defined (CONFIG_IDF_TARGET_ESP32)  // ESP-IDF
+#elif defined (CONFIG_IDF_TARGET_ESP32) || defined (LGFX_HOST) // ESP-IDF or host
 
     void createFromBmpFile(const char *path) {
       FileWrapper file;
@@ -237,6 +257,51 @@ namespace lgfx
       if (_palette && index < _palette_count) { _palette[index].set(r, g, b); }
     }
 
+    // build the palette from the colors of an image. (median cut)
+    template<typename T>
+    bool createPaletteFromImage(const T* data, std::int32_t w, std::int32_t h) { return create_palette_from_image(data, w, h); }
+    bool createPaletteFromImage(const std::uint16_t* data, std::int32_t w, std::int32_t h)
+    {
+      return _swapBytes ? create_palette_from_image((const rgb565_t*)data, w, h)
+                        : create_palette_from_image((const swap565_t*)data, w, h);
+    }
+    bool createPaletteFromImage(const void* data, std::int32_t w, std::int32_t h)
+    {
+      return _swapBytes ? create_palette_from_image((const rgb888_t*)data, w, h)
+                        : create_palette_from_image((const bgr888_t*)data, w, h);
+    }
+
+    // draw an image with the nearest palette colors. (optional ordered dithering)
+    template<typename T>
+    void pushImageQuantize(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const T* data, bool dither = false) { push_image_quantize(x, y, w, h, data, dither); }
+    void pushImageQuantize(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const std::uint16_t* data, bool dither = false)
+    {
+      if (_swapBytes) push_image_quantize(x, y, w, h, (const rgb565_t*)data, dither);
+      else            push_image_quantize(x, y, w, h, (const swap565_t*)data, dither);
+    }
+    void pushImageQuantize(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const void* data, bool dither = false)
+    {
+      if (_swapBytes) push_image_quantize(x, y, w, h, (const rgb888_t*)data, dither);
+      else            push_image_quantize(x, y, w, h, (const bgr888_t*)data, dither);
+    }
+
+    // create a palette sprite (1/2/4/8 bpp) from a full color image.
+    template<typename T>
+    void* createFromImage(std::int32_t w, std::int32_t h, const T* data, std::uint8_t bpp = 4, bool dither = false)
+    {
+      if (bpp > 8) return nullptr;
+      deleteSprite();
+      setColorDepth(bpp);
+      if (!createSprite(w, h)) return nullptr;
+      if ((!_palette && !createPalette())
+       || !createPaletteFromImage(data, w, h)) {
+        deleteSprite();
+        return nullptr;
+      }
+      pushImageQuantize(0, 0, w, h, data, dither);
+      return _img;
+    }
+
     __attribute__ ((always_inline)) inline void* setColorDepth(std::uint8_t bpp) { return setColorDepth((color_depth_t)bpp); }
     void* setColorDepth(color_depth_t depth)
     {
@@ -250,20 +315,20 @@ namespace lgfx
 
     std::uint32_t readPixelValue(std::int32_t x, std::int32_t y)
     {
+      auto line = &_img[_row(y) * _stride];
       auto bits = _read_conv.bits;
       if (bits >= 8) {
-        std::int32_t index = x + y * _bitwidth;
         if (bits == 8) {
-          return _img[index];
+          return line[x];
         } else if (bits == 16) {
-          return _img16[index];
+          return ((std::uint16_t*)line)[x];
         } else {
-          return (std::uint32_t)_img24[index];
+          return (std::uint32_t)((bgr888_t*)line)[x];
         }
       } else {
-        std::int32_t index = (x + y * _bitwidth) * bits;
+        std::int32_t index = x * bits;
         std::uint8_t mask = (1 << bits) - 1;
-        return (_img[index >> 3] >> (-(index + bits) & 7)) & mask;
+        return (line[index >> 3] >> (-(index + bits) & 7)) & mask;
       }
     }
 
@@ -301,16 +366,67 @@ namespace lgfx
       std::uint16_t* _img16;
       bgr888_t* _img24;
     };
-    std::int32_t _bitwidth;
+    void* _img_mem = nullptr;  // allocated memory (before alignment)
+    std::uint32_t _stride;     // bytes per row
     std::int32_t _xptr;
     std::int32_t _yptr;
     std::int32_t _xs;
     std::int32_t _xe;
     std::int32_t _ys;
     std::int32_t _ye;
-    std::int32_t _index;
+    std::int32_t _ring_y = 0;   // ring buffer area (full width rows)
+    std::int32_t _ring_h = 0;
+    std::int32_t _ring_ofs = 0; // physical row offset of the first row in the area
+    std::uint8_t* _quantize_buf = nullptr;  // work area of the palette quantizer, kept until deleteSprite
+    std::uint32_t _quantize_cap = 0;
     bool _disable_memcpy = false; // disable PSRAM to PSRAM memcpy flg.
     bool _psram = false;
+    bool _ring_enable = false;
+
+    // logical row to buffer row.
+    __attribute__ ((always_inline)) inline std::int32_t _row(std::int32_t y) const
+    {
+      std::uint32_t r = y - _ring_y;
+      if (r >= (std::uint32_t)_ring_h) return y;
+      r += _ring_ofs;
+      if (r >= (std::uint32_t)_ring_h) r -= _ring_h;
+      return _ring_y + r;
+    }
+
+    // number of rows from y (max h) that are stored contiguously.
+    std::int32_t _row_run(std::int32_t y, std::int32_t h) const
+    {
+      if (!_ring_ofs) return h;
+      std::int32_t boundary;
+      if (y < _ring_y) boundary = _ring_y;
+      else if (y < _ring_y + _ring_h - _ring_ofs) boundary = _ring_y + _ring_h - _ring_ofs;
+      else if (y < _ring_y + _ring_h) boundary = _ring_y + _ring_h;
+      else return h;
+      return std::min(h, boundary - y);
+    }
+
+    void ring_normalize(void)
+    {
+      if (_ring_ofs) {
+        std::uint32_t len = _stride;
+        auto top = &_img[_ring_y * len];
+        std::rotate(top, top + _ring_ofs * len, top + _ring_h * len);
+      }
+      _ring_y = _ring_h = _ring_ofs = 0;
+    }
+
+    bool scrollRows_impl(std::int32_t y, std::int32_t h, std::int32_t dy) override
+    {
+      if (!_ring_enable) return false;
+      if (_ring_y != y || _ring_h != h) {
+        ring_normalize();
+        _ring_y = y;
+        _ring_h = h;
+      }
+      _ring_ofs = (_ring_ofs - dy) % h;
+      if (_ring_ofs < 0) _ring_ofs += h;
+      return true;
+    }
 
     bool create_palette(void)
     {
@@ -329,6 +445,214 @@ namespace lgfx
       return true;
     }
 
+    // RGB444 histogram cell index.
+    template <typename T>
+    static inline std::uint32_t quantize_cell(const T& c) { return (c.R8() >> 4) << 8 | (c.G8() >> 4) << 4 | c.B8() >> 4; }
+
+    struct quantize_box_t {
+      std::uint8_t lo[3];
+      std::uint8_t hi[3];
+      std::uint32_t count;
+    };
+
+    // shrink the box to the occupied cells. returns false if the box is empty.
+    static bool quantize_shrink(quantize_box_t* box, const std::uint32_t* hist)
+    {
+      std::uint8_t lo[3] = { 15, 15, 15 };
+      std::uint8_t hi[3] = { 0, 0, 0 };
+      std::uint32_t count = 0;
+      for (std::uint32_t r = box->lo[0]; r <= box->hi[0]; ++r) {
+        for (std::uint32_t g = box->lo[1]; g <= box->hi[1]; ++g) {
+          auto h = &hist[r << 8 | g << 4];
+          for (std::uint32_t b = box->lo[2]; b <= box->hi[2]; ++b) {
+            if (!h[b]) continue;
+            count += h[b];
+            lo[0] = std::min<std::uint32_t>(lo[0], r);
+            hi[0] = std::max<std::uint32_t>(hi[0], r);
+            lo[1] = std::min<std::uint32_t>(lo[1], g);
+            hi[1] = std::max<std::uint32_t>(hi[1], g);
+            lo[2] = std::min<std::uint32_t>(lo[2], b);
+            hi[2] = std::max<std::uint32_t>(hi[2], b);
+          }
+        }
+      }
+      box->count = count;
+      if (!count) return false;
+      memcpy(box->lo, lo, 3);
+      memcpy(box->hi, hi, 3);
+      return true;
+    }
+
+    template <typename T>
+    bool create_palette_from_image(const T* data, std::int32_t w, std::int32_t h)
+    {
+      if (!_palette || !data || w < 1 || h < 1) return false;
+
+      // histogram(4096) + cell to box map(4096) + boxes(256) + color sums(256 * 4)
+      std::uint32_t boxes = _palette_count;
+      std::uint32_t need = 4096 * sizeof(std::uint32_t) + 4096 + boxes * (sizeof(quantize_box_t) + 4 * sizeof(std::uint32_t));
+      if (!heap_reserve(_quantize_buf, _quantize_cap, need, need)) return false;
+      auto hist = (std::uint32_t*)_quantize_buf;
+      auto cellmap = (std::uint8_t*)&hist[4096];
+      auto box = (quantize_box_t*)&cellmap[4096];
+      auto sum = (std::uint32_t*)&box[boxes];
+      memset(hist, 0, 4096 * sizeof(std::uint32_t));
+
+      std::uint32_t len = w * h;
+      for (std::uint32_t i = 0; i < len; ++i) ++hist[quantize_cell(data[i])];
+
+      box[0].lo[0] = box[0].lo[1] = box[0].lo[2] = 0;
+      box[0].hi[0] = box[0].hi[1] = box[0].hi[2] = 15;
+      quantize_shrink(&box[0], hist);
+      std::uint32_t n = 1;
+      while (n < boxes) {
+        // split the most populated box along its longest axis.
+        std::int32_t target = -1;
+        std::uint32_t axis = 0;
+        for (std::uint32_t i = 0; i < n; ++i) {
+          std::uint32_t a = 1;
+          if (box[i].hi[0] - box[i].lo[0] > box[i].hi[a] - box[i].lo[a]) a = 0;
+          if (box[i].hi[2] - box[i].lo[2] > box[i].hi[a] - box[i].lo[a]) a = 2;
+          if (box[i].hi[a] == box[i].lo[a]) continue;
+          if (target < 0 || box[target].count < box[i].count) { target = i; axis = a; }
+        }
+        if (target < 0) break;
+
+        auto b = &box[target];
+        std::uint32_t plane[16] = {0};
+        for (std::uint32_t r = b->lo[0]; r <= b->hi[0]; ++r) {
+          for (std::uint32_t g = b->lo[1]; g <= b->hi[1]; ++g) {
+            for (std::uint32_t bl = b->lo[2]; bl <= b->hi[2]; ++bl) {
+              std::uint32_t idx = (axis == 0) ? r : (axis == 1) ? g : bl;
+              plane[idx] += hist[r << 8 | g << 4 | bl];
+            }
+          }
+        }
+        std::uint32_t half = b->count >> 1;
+        std::uint32_t acc = 0;
+        std::uint32_t split = b->lo[axis];
+        while (split < b->hi[axis] - 1u && (acc += plane[split]) < half) ++split;
+
+        box[n] = *b;
+        b->hi[axis] = split;
+        box[n].lo[axis] = split + 1;
+        quantize_shrink(b, hist);
+        quantize_shrink(&box[n], hist);
+        ++n;
+      }
+
+      for (std::uint32_t i = 0; i < n; ++i) {
+        for (std::uint32_t r = box[i].lo[0]; r <= box[i].hi[0]; ++r) {
+          for (std::uint32_t g = box[i].lo[1]; g <= box[i].hi[1]; ++g) {
+            memset(&cellmap[r << 8 | g << 4 | box[i].lo[2]], i, box[i].hi[2] - box[i].lo[2] + 1);
+          }
+        }
+      }
+
+      // the palette color is the average of the pixels in the box.
+      memset(sum, 0, boxes * 4 * sizeof(std::uint32_t));
+      for (std::uint32_t i = 0; i < len; ++i) {
+        auto s = &sum[cellmap[quantize_cell(data[i])] << 2];
+        s[0] += data[i].R8();
+        s[1] += data[i].G8();
+        s[2] += data[i].B8();
+        ++s[3];
+      }
+      for (std::uint32_t i = 0; i < boxes; ++i) {
+        auto s = &sum[i << 2];
+        if (i < n && s[3]) {
+          std::uint32_t round = s[3] >> 1;
+          _palette[i].set((s[0] + round) / s[3], (s[1] + round) / s[3], (s[2] + round) / s[3]);
+        } else {
+          _palette[i].set(0, 0, 0);
+        }
+      }
+      return true;
+    }
+
+    template <typename T>
+    void push_image_quantize(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const T* data, bool dither)
+    {
+      if (!_palette || !data) return;
+
+      std::int32_t src_w = w;
+      std::int32_t dx = 0, dy = 0;
+      if (x < _clip_l) { dx = _clip_l - x; w -= dx; x = _clip_l; }
+      if (w > _clip_r - x + 1) { w = _clip_r - x + 1; }
+      if (w < 1) return;
+      if (y < _clip_t) { dy = _clip_t - y; h -= dy; y = _clip_t; }
+      if (h > _clip_b - y + 1) { h = _clip_b - y + 1; }
+      if (h < 1) return;
+
+      // nearest palette index for each RGB444 cell.
+      if (!heap_reserve(_quantize_buf, _quantize_cap, 4096, 4096)) return;
+      auto grid = _quantize_buf;
+      for (std::uint32_t cell = 0; cell < 4096; ++cell) {
+        std::int32_t r = (cell >> 4 & 0xF0) | 8;
+        std::int32_t g = (cell      & 0xF0) | 8;
+        std::int32_t b = (cell << 4 & 0xF0) | 8;
+        std::uint32_t best = ~0u;
+        std::uint32_t i = 0;
+        do {
+          std::int32_t dr = r - _palette[i].r;
+          std::int32_t dg = g - _palette[i].g;
+          std::int32_t db = b - _palette[i].b;
+          std::uint32_t d = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+          if (best > d) { best = d; grid[cell] = i; }
+        } while (++i < _palette_count);
+      }
+
+      data += dx + dy * src_w;
+      if (!_clip_count) quantize_rect(x, y, w, h, data, src_w, dither);
+      else {
+        std::int32_t xe = x + w - 1, ye = y + h - 1;
+        for (std::uint32_t i = 0; i < _clip_count; ++i) {
+          auto& c = _clip_rects[i];
+          std::int32_t l = std::max<std::int32_t>(x, c.l), r = std::min<std::int32_t>(xe, c.r);
+          std::int32_t t = std::max<std::int32_t>(y, c.t), b = std::min<std::int32_t>(ye, c.b);
+          if (l > r || t > b) continue;
+          quantize_rect(l, t, r - l + 1, b - t + 1, &data[(l - x) + (t - y) * src_w], src_w, dither);
+        }
+      }
+    }
+
+    // write the rect through the cell to index grid in _quantize_buf.
+    template <typename T>
+    void quantize_rect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const T* data, std::int32_t src_w, bool dither)
+    {
+      // 4x4 bayer matrix, spread matched to the palette density.
+      static constexpr std::uint8_t bayer[16] = { 0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5 };
+      std::int32_t spread = (_palette_count <= 4) ? 64 : (_palette_count <= 16) ? 32 : 16;
+
+      auto grid = _quantize_buf;
+      std::int32_t bits = _write_conv.bits;
+      std::uint8_t mask = (1 << bits) - 1;
+      do {
+        auto src = data;
+        auto line = &_img[_row(y) * _stride];
+        std::int32_t index = x * bits;
+        std::int32_t i = 0;
+        do {
+          std::int32_t r = src[i].R8();
+          std::int32_t g = src[i].G8();
+          std::int32_t b = src[i].B8();
+          if (dither) {
+            std::int32_t d = ((bayer[((y & 3) << 2) | ((x + i) & 3)] * 2 - 15) * spread) >> 5;
+            r = std::min(255, std::max(0, r + d));
+            g = std::min(255, std::max(0, g + d));
+            b = std::min(255, std::max(0, b + d));
+          }
+          std::uint32_t c = grid[(r >> 4) << 8 | (g >> 4) << 4 | b >> 4];
+          auto dst = &line[index >> 3];
+          std::uint32_t shift = -(index + bits) & 7;
+          *dst = (*dst & ~(mask << shift)) | (c << shift);
+          index += bits;
+        } while (++i < w);
+        data += src_w;
+        ++y;
+      } while (--h);
+    }
+
     void createFromBmpFile(FileWrapper* file, const char *path) {
       file->need_transaction = false;
       if (file->open(path, "r")) {
@@ -373,6 +697,7 @@ namespace lgfx
       data->seek(seekOffset);
 
       size_t buffersize = ((w * bpp + 31) >> 5) << 2;  // readline 4Byte align.
+      size_t linelength = w * bpp >> 3;               // without the padding
       std::uint8_t lineBuffer[buffersize];  // readline 4Byte align.
       if (bpp <= 8) {
         do {
@@ -384,24 +709,24 @@ namespace lgfx
           } else {
             data->read(lineBuffer, buffersize);
           }
-          memcpy(&_img[y * _bitwidth * bpp >> 3], lineBuffer, w * bpp >> 3);
+          memcpy(&_img[y * _stride], lineBuffer, linelength);
           y += flow;
         } while (--h);
       } else if (bpp == 16) {
         do {
           data->read(lineBuffer, buffersize);
-          auto img = &_img[y * _bitwidth * bpp >> 3];
+          auto img = &_img[y * _stride];
           y += flow;
-          for (size_t i = 0; i < buffersize; ++i) {
+          for (size_t i = 0; i < linelength; ++i) {
             img[i] = lineBuffer[i ^ 1];
           }
         } while (--h);
       } else if (bpp == 24) {
         do {
           data->read(lineBuffer, buffersize);
-          auto img = &_img[y * _bitwidth * bpp >> 3];
+          auto img = &_img[y * _stride];
           y += flow;
-          for (size_t i = 0; i < buffersize; i += 3) {
+          for (size_t i = 0; i < linelength; i += 3) {
             img[i    ] = lineBuffer[i + 2];
             img[i + 1] = lineBuffer[i + 1];
             img[i + 2] = lineBuffer[i    ];
@@ -410,7 +735,7 @@ namespace lgfx
       } else if (bpp == 32) {
         do {
           data->read(lineBuffer, buffersize);
-          auto img = &_img[y * _bitwidth * 3];
+          auto img = &_img[y * _stride];
           y += flow;
           for (size_t i = 0; i < buffersize; i += 4) {
             img[(i>>2)*3    ] = lineBuffer[i + 2];
@@ -425,12 +750,26 @@ namespace lgfx
     void push_sprite(LovyanGFX* dst, std::int32_t x, std::int32_t y, std::uint32_t transp = ~0)
     {
       pixelcopy_t p(_img, dst->getColorDepth(), getColorDepth(), dst->hasPalette(), _palette, transp);
-      dst->push_image(x, y, _width, _height, &p, !_disable_memcpy); // DMA disable with use SPIRAM
+      if (!_ring_ofs) {
+        dst->push_image(x, y, _width, _height, &p, !_disable_memcpy, _stride); // DMA disable with use SPIRAM
+        return;
+      }
+      // push each contiguous part of the ring buffer.
+      std::int32_t ly = 0;
+      std::int32_t h = _height;
+      std::int32_t n;
+      do {
+        n = _row_run(ly, h);
+        p.src_data = &_img[_row(ly) * _stride];
+        dst->push_image(x, y + ly, _width, n, &p, !_disable_memcpy, _stride);
+        ly += n;
+      } while (h -= n);
     }
 
     inline bool push_rotate_zoom(LovyanGFX* dst, std::int32_t x, std::int32_t y, float angle, float zoom_x, float zoom_y, std::uint32_t transp = ~0)
     {
-      return dst->pushImageRotateZoom(x, y, _img, _xpivot, _ypivot, _width, _height, angle, zoom_x, zoom_y, transp, getColorDepth(), _palette);
+      ring_normalize();
+      return dst->pushImageRotateZoom(x, y, _img, _xpivot, _ypivot, _width, _height, angle, zoom_x, zoom_y, transp, getColorDepth(), _palette, _stride);
     }
 
     void set_window(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye)
@@ -447,7 +786,6 @@ namespace lgfx
         _xe = std::min(xe, _width  - 1);
         _ye = std::min(ye, _height - 1);
       }
-      _index = xs + ys * _bitwidth;
     }
 
     void setWindow_impl(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye) override
@@ -455,23 +793,135 @@ namespace lgfx
       set_window(xs, ys, xe, ye);
     }
 
-    void drawPixel_impl(std::int32_t x, std::int32_t y) override
+    __attribute__ ((always_inline)) inline void set_pixel(std::int32_t x, std::int32_t y, raw_color_t color)
     {
+      auto line = &_img[_row(y) * _stride];
       auto bits = _write_conv.bits;
       if (bits >= 8) {
-        std::int32_t index = x + y * _bitwidth;
         if (bits == 8) {
-          _img[index] = _color.raw0;
+          line[x] = color.raw0;
         } else if (bits == 16) {
-          _img16[index] = _color.rawL;
+          ((std::uint16_t*)line)[x] = color.rawL;
         } else {
-          _img24[index] = *(bgr888_t*)&_color;
+          ((bgr888_t*)line)[x] = *(bgr888_t*)&color;
         }
       } else {
-        std::int32_t index = (x + y * _bitwidth) * bits;
-        std::uint8_t* dst = &_img[index >> 3];
+        std::int32_t index = x * bits;
+        std::uint8_t* dst = &line[index >> 3];
         std::uint8_t mask = (std::uint8_t)(~(0xFF >> bits)) >> (index & 7);
-        *dst = (*dst & ~mask) | (_color.raw0 & mask);
+        *dst = (*dst & ~mask) | (color.raw0 & mask);
+      }
+    }
+
+    void drawPixel_impl(std::int32_t x, std::int32_t y) override
+    {
+      set_pixel(x, y, _color);
+    }
+
+    void drawPixels_impl(const point_t* points, const std::uint32_t* rawcolors, std::uint32_t count) override
+    {
+      raw_color_t color = _color;
+      std::int32_t cl = _clip_l, cr = _clip_r, ct = _clip_t, cb = _clip_b;
+      for (std::uint32_t i = 0; i < count; ++i) {
+        std::int32_t x = points[i].x;
+        std::int32_t y = points[i].y;
+        if (x < cl || x > cr || y < ct || y > cb) continue;
+        if (rawcolors) color = rawcolors[i];
+        set_pixel(x, y, color);
+      }
+    }
+
+    // flood fill straight on the buffer : the raw pixels are compared and filled without readback.
+    struct paint_direct_t
+    {
+      LGFX_Sprite* s;
+      std::uint32_t target;
+      std::uint32_t fill_raw;
+      std::int32_t cl, cr;
+      std::uint32_t bits;
+
+      const std::uint8_t* line(std::int32_t y) const { return &s->_img[s->_row(y) * s->_stride]; }
+      std::uint32_t raw(const std::uint8_t* line, std::int32_t x) const
+      {
+        if (bits == 16) return ((const std::uint16_t*)line)[x];
+        if (bits ==  8) return line[x];
+        if (bits == 24) { auto p = &line[x * 3]; return p[0] | p[1] << 8 | p[2] << 16; }
+        std::int32_t index = x * bits;
+        return (line[index >> 3] >> (-(index + bits) & 7)) & ((1 << bits) - 1);
+      }
+
+      bool match(std::int32_t x, std::int32_t y) const { return raw(line(y), x) == target; }
+      bool filled(std::int32_t x, std::int32_t y) const { return raw(line(y), x) == fill_raw; }
+      std::int32_t left(std::int32_t x, std::int32_t y) const
+      {
+        auto l = line(y);
+        while (x > cl && raw(l, x - 1) == target) --x;
+        return x;
+      }
+      std::int32_t right(std::int32_t x, std::int32_t y) const
+      {
+        auto l = line(y);
+        while (x < cr && raw(l, x + 1) == target) ++x;
+        return x;
+      }
+      void fill(std::int32_t l, std::int32_t r, std::int32_t y) { s->fill_rect(l, s->_row(y), r - l + 1, 1); }
+    };
+
+    void paint_impl(std::int32_t x, std::int32_t y) override
+    {
+      std::uint32_t bits = _write_conv.bits;
+      std::uint32_t fill = (bits > 16) ? _color.raw & 0xFFFFFF
+                         : (bits == 16) ? _color.rawL
+                         : (bits ==  8) ? _color.raw0
+                                        : _color.raw0 & ((1 << bits) - 1);
+      paint_direct_t d = { this, 0, fill, _clip_l, _clip_r, bits };
+      d.target = d.raw(d.line(y), x);
+      if (d.target != fill) flood_fill(d, x, y);
+    }
+
+    // blend in the native pixel format, channel by channel.
+    void writeAlphaSpan_impl(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* alpha) override
+    {
+      auto line = &_img[_row(y) * _stride];
+      auto bits = _write_conv.bits;
+      if (hasPalette() || bits < 8) {
+        for (std::int32_t i = 0; i < w; ++i) {
+          if (alpha[i] >= 128) set_pixel(x + i, y, _color);
+        }
+      } else if (bits == 16) {
+        std::uint32_t fore = __builtin_bswap16(_color.rawL);
+        std::int32_t fr = fore >> 11, fg = (fore >> 5) & 0x3F, fb = fore & 0x1F;
+        auto dst = &((std::uint16_t*)line)[x];
+        for (std::int32_t i = 0; i < w; ++i) {
+          if (!alpha[i]) continue;
+          std::int32_t p = alpha[i] + 1;
+          std::uint32_t back = __builtin_bswap16(dst[i]);
+          std::uint32_t r = (fr * p + (back >> 11        ) * (256 - p) + 128) >> 8;
+          std::uint32_t g = (fg * p + ((back >> 5) & 0x3F) * (256 - p) + 128) >> 8;
+          std::uint32_t b = (fb * p + (back & 0x1F       ) * (256 - p) + 128) >> 8;
+          dst[i] = __builtin_bswap16(r << 11 | g << 5 | b);
+        }
+      } else if (bits == 8) {
+        std::int32_t fr = _color.raw0 >> 5, fg = (_color.raw0 >> 2) & 7, fb = _color.raw0 & 3;
+        auto dst = &line[x];
+        for (std::int32_t i = 0; i < w; ++i) {
+          if (!alpha[i]) continue;
+          std::int32_t p = alpha[i] + 1;
+          std::uint32_t back = dst[i];
+          std::uint32_t r = (fr * p + (back >> 5      ) * (256 - p) + 128) >> 8;
+          std::uint32_t g = (fg * p + ((back >> 2) & 7) * (256 - p) + 128) >> 8;
+          std::uint32_t b = (fb * p + (back & 3       ) * (256 - p) + 128) >> 8;
+          dst[i] = r << 5 | g << 2 | b;
+        }
+      } else {  // bgr888 / bgr666
+        auto dst = &line[x * 3];
+        for (std::int32_t i = 0; i < w; ++i, dst += 3) {
+          if (!alpha[i]) continue;
+          std::int32_t p = alpha[i] + 1;
+          dst[0] = (_color.raw0 * p + dst[0] * (256 - p)) >> 8;
+          dst[1] = (_color.raw1 * p + dst[1] * (256 - p)) >> 8;
+          dst[2] = (_color.raw2 * p + dst[2] * (256 - p)) >> 8;
+        }
       }
     }
 
@@ -482,71 +932,69 @@ setWindow(x,y,x+w-1,y+h-1);
 pushBlock_impl(w*h);
 return;
 //*/
+      if (!_ring_ofs) {
+        fill_rect(x, y, w, h);
+        return;
+      }
+      std::int32_t n;
+      do {
+        n = _row_run(y, h);
+        fill_rect(x, _row(y), w, n);
+        y += n;
+      } while (h -= n);
+    }
+
+    // fill in buffer rows.
+    void fill_rect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
       std::uint32_t bits = _write_conv.bits;
       if (bits >= 8) {
+        std::uint32_t bytes = bits >> 3;
+        std::uint32_t add_dst = _stride;
+        std::uint8_t* dst = &_img[x * bytes + y * add_dst];
         if (w == 1) {
-          std::uint32_t bw = _bitwidth;
-          std::uint32_t index = x + y * bw;
           if (bits == 8) {
             std::uint8_t c = _color.raw0;
-            auto img = &_img[index];
-            do { *img = c;  img += bw; } while (--h);
+            do { *dst = c;  dst += add_dst; } while (--h);
           } else if (bits == 16) {
             std::uint16_t c = _color.rawL;
-            auto img = &_img16[index];
-            do { *img = c;  img += bw; } while (--h);
+            do { *(std::uint16_t*)dst = c;  dst += add_dst; } while (--h);
           } else {  // if (_write_conv.bytes == 3)
             auto c = _color;
-            auto img = &_img24[index];
-            do { img->r = c.raw0; img->g = c.raw1; img->b = c.raw2; img += bw; } while (--h);
+            do { dst[0] = c.raw0; dst[1] = c.raw1; dst[2] = c.raw2; dst += add_dst; } while (--h);
           }
         } else {
-          std::uint32_t bytes = bits >> 3;
-          std::int32_t bw = _bitwidth;
-          std::uint8_t* dst = &_img[(x + y * bw) * bytes];
-          std::uint8_t c = _color.raw0;
-          if (bytes == 1 || (c == _color.raw1 && (bytes == 2 || (c == _color.raw2)))) {
-            if (w == bw) {
-              memset(dst, c, w * bytes * h);
-            } else {
-              std::uint32_t add_dst = bw * bytes;
-              do {
-                memset(dst, c, w * bytes);
-                dst += add_dst;
-              } while (--h);
+          std::uint32_t color = _color.raw;
+          if (w * bytes == add_dst) {  // full rows
+            memset_multi(dst, color, bytes, w * h);
+            return;
+          }
+          memset_multi(dst, color, bytes, w);
+          if (_disable_memcpy) {  // avoid reading back from PSRAM
+            while (--h) {
+              dst += add_dst;
+              memset_multi(dst, color, bytes, w);
             }
           } else {
             size_t len = w * bytes;
-            std::uint32_t add_dst = bw * bytes;
-            std::uint32_t color = _color.raw;
-            if (_disable_memcpy) {
-              std::uint8_t linebuf[len];
-              memset_multi(linebuf, color, bytes, w);
-              do {
-                memcpy(dst, linebuf, len);
-                dst += add_dst;
-              } while (--h);
-            } else {
-              if (w == bw) {
-                memset_multi(dst, color, bytes, w * h);
-              } else {
-                memset_multi(dst, color, bytes, w);
-                while (--h) {
-                  memcpy(dst + add_dst, dst, len);
-                  dst += add_dst;
-                }
-              }
+            while (--h) {
+              memcpy(dst + add_dst, dst, len);
+              dst += add_dst;
             }
           }
         }
       } else {
         x *= bits;
         w *= bits;
-        size_t add_dst = _bitwidth * bits >> 3;
+        size_t add_dst = _stride;
         std::uint8_t* dst = &_img[y * add_dst + (x >> 3)];
+        std::uint8_t c = _color.raw0;
+        if ((std::uint32_t)w == add_dst << 3) {
+          memset(dst, c, add_dst * h);
+          return;
+        }
         std::uint32_t len = ((x + w) >> 3) - (x >> 3);
         std::uint8_t mask = 0xFF >> (x & 7);
-        std::uint8_t c = _color.raw0;
         if (len) {
           if (mask != 0xFF) {
             --len;
@@ -578,12 +1026,11 @@ return;
         std::int32_t bits = _write_conv.bits;
         std::uint8_t c = _color.raw0;
         std::int32_t ll;
-        std::int32_t index = _index;
         do {
-          std::uint8_t* dst = &_img[index * bits >> 3];
           ll = std::min(_xe - _xptr + 1, length);
           std::int32_t w = ll * bits;
           std::int32_t x = _xptr * bits;
+          std::uint8_t* dst = &_img[_row(_yptr) * _stride + (x >> 3)];
           size_t len = ((x + w) >> 3) - (x >> 3);
           std::uint8_t mask = 0xFF >> (x & 7);
           if (!len) {
@@ -602,98 +1049,72 @@ return;
             mask = 0xFF >> ((x + w) & 7);
             if (mask != 0xFF) *dst = (*dst & mask) | (c & ~mask);
           }
-          index = ptr_advance(ll);
+          ptr_advance(ll);
         } while (length -= ll);
       } else {
         std::uint32_t bytes = _write_conv.bytes;
-        if (bytes == 1 || (_color.raw0 == _color.raw1 && (bytes == 2 || (_color.raw0 == _color.raw2)))) {
-          std::uint32_t color = _color.raw;
-          std::int32_t ll;
-          std::int32_t index = _index;
-          do {
-            ll = std::min(_xe - _xptr + 1, length);
-            memset(&_img[index * bytes], color, ll * bytes);
-            index = ptr_advance(ll);
-          } while (length -= ll);
-        } else
-        if (_disable_memcpy) {
-          std::int32_t buflen = std::min(_xe - _xs + 1, length);
-          std::uint8_t linebuf[buflen * bytes];
-          memset_multi(linebuf, _color.raw, bytes, buflen);
-          std::int32_t ll;
-          std::int32_t index = _index;
-          do  {
-            ll = std::min(_xe - _xptr + 1, length);
-            memcpy(&_img[index * bytes], linebuf, ll * bytes);
-            index = ptr_advance(ll);
-          } while (length -= ll);
-          return;
-        } else {
-          std::uint32_t color = _color.raw;
-          std::int32_t ll;
-          std::int32_t index = _index;
-          do {
-            ll = std::min(_xe - _xptr + 1, length);
-            memset_multi(&_img[index * bytes], color, bytes, ll);
-            index = ptr_advance(ll);
-          } while (length -= ll);
-        }
+        std::uint32_t color = _color.raw;
+        std::int32_t ll;
+        do {
+          ll = std::min(_xe - _xptr + 1, length);
+          memset_multi(&_img[_row(_yptr) * _stride + _xptr * bytes], color, bytes, ll);
+          ptr_advance(ll);
+        } while (length -= ll);
       }
     }
 
     void copyRect_impl(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y) override
     {
+      std::int32_t add_y = 1;
+      if (src_y < dst_y) {
+        add_y = -1;
+        src_y += h - 1;
+        dst_y += h - 1;
+      }
       if (_write_conv.bits < 8) {
         pixelcopy_t param(_img, _write_conv.depth, _write_conv.depth);
-        param.src_width = _bitwidth;
-        std::int32_t add_y = (src_y < dst_y) ? -1 : 1;
+        param.src_stride = _stride;
         if (src_y != dst_y) {
-          if (src_y < dst_y) {
-            src_y += h - 1;
-            dst_y += h - 1;
-          }
-          param.src_y = src_y;
           do {
             param.src_x = src_x;
-            auto idx = dst_x + dst_y * _bitwidth;
-            param.fp_copy(_img, idx, idx + w, &param);
+            param.src_y = _row(src_y);
+            param.fp_copy(&_img[_row(dst_y) * _stride], dst_x, dst_x + w, &param);
             dst_y += add_y;
-            param.src_y += add_y;
+            src_y += add_y;
           } while (--h);
         } else {
-          size_t len = (_bitwidth * _write_conv.bits) >> 3;
+          size_t len = _stride;
           std::uint8_t buf[len];
           param.src_data = buf;
           param.src_y32 = 0;
           do {
-            memcpy(buf, &_img[src_y * len], len);
+            auto line = &_img[_row(src_y) * len];
+            memcpy(buf, line, len);
             param.src_x = src_x;
-            auto idx = dst_x + dst_y * _bitwidth;
-            param.fp_copy(_img, idx, idx + w, &param);
+            param.fp_copy(line, dst_x, dst_x + w, &param);
             dst_y += add_y;
             src_y += add_y;
           } while (--h);
         }
       } else {
-        size_t len = w * _write_conv.bytes;
-        std::int32_t add = _bitwidth * _write_conv.bytes;
-        if (src_y < dst_y) add = -add;
-        std::int32_t pos = (src_y < dst_y) ? h - 1 : 0;
-        std::uint8_t* src = &_img[(src_x + (src_y + pos) * _bitwidth) * _write_conv.bytes];
-        std::uint8_t* dst = &_img[(dst_x + (dst_y + pos) * _bitwidth) * _write_conv.bytes];
+        std::int32_t bytes = _write_conv.bytes;
+        size_t len = w * bytes;
+        std::int32_t bw = _stride;
+        src_x *= bytes;
+        dst_x *= bytes;
         if (_disable_memcpy) {
           std::uint8_t buf[len];
           do {
-            memcpy(buf, src, len);
-            memcpy(dst, buf, len);
-            dst += add;
-            src += add;
+            memcpy(buf, &_img[src_x + _row(src_y) * bw], len);
+            memcpy(&_img[dst_x + _row(dst_y) * bw], buf, len);
+            dst_y += add_y;
+            src_y += add_y;
           } while (--h);
         } else {
           do {
-            memmove(dst, src, len);
-            src += add;
-            dst += add;
+            memmove(&_img[dst_x + _row(dst_y) * bw], &_img[src_x + _row(src_y) * bw], len);
+            dst_y += add_y;
+            src_y += add_y;
           } while (--h);
         }
       }
@@ -704,19 +1125,18 @@ return;
       h += y;
       if (param->no_convert && _read_conv.bytes) {
         auto b = _read_conv.bytes;
-        auto bw = _bitwidth;
         auto d = (std::uint8_t*)dst;
         do {
-          memcpy(d, &_img[(x + y * bw) * b], w * b);
+          memcpy(d, &_img[x * b + _row(y) * _stride], w * b);
           d += w * b;
         } while (++y != h);
       } else {
-        param->src_width = _bitwidth;
+        param->src_stride = _stride;
         param->src_data = _img;
         std::int32_t dstindex = 0;
         do {
           param->src_x = x;
-          param->src_y = y;
+          param->src_y = _row(y);
           dstindex = param->fp_copy(dst, dstindex, dstindex + w, param);
         } while (++y != h);
       }
@@ -731,29 +1151,30 @@ return;
                                : (bits == 2) ? 3
                                              : 1;
         if (0 == (bits & 7) || ((sx & mask) == (x & mask) && (w == this->_width || 0 == (w & mask)))) {
-          auto bw = _bitwidth * bits >> 3;
-          auto dd = &_img[bw * y];
-          auto sw = param->src_width * bits >> 3;
+          auto bw = _stride;
+          auto sw = param->src_stride;
           auto sd = &((std::uint8_t*)param->src_data)[param->src_y * sw];
-          if (sw == bw && this->_width == w && sx == 0 && x == 0) {
-            memcpy(dd, sd, bw * h);
+          if (sw == bw && this->_width == w && sx == 0 && x == 0 && _row_run(y, h) == h) {
+            memcpy(&_img[bw * _row(y)], sd, bw * h);
             return;
           }
-          y = 0;
-          w =   w * bits >> 3;
+          w = (w * bits + 7) >> 3;
           x =   x * bits >> 3;
           sx = sx * bits >> 3;
+          h += y;
           do {
-            memcpy(&dd[y * bw + x], &sd[y * sw + sx], w);
+            memcpy(&_img[_row(y) * bw + x], &sd[sx], w);
+            sd += sw;
           } while (++y != h);
           return;
         }
       }
 
       do {
-        std::int32_t pos = x + (y++) * _bitwidth;
+        auto line = &_img[_row(y++) * _stride];
+        std::int32_t pos = x;
         std::int32_t end = pos + w;
-        while (end != (pos = param->fp_copy(_img, pos, end, param))) {
+        while (end != (pos = param->fp_copy(line, pos, end, param))) {
           if ( end == (pos = param->fp_skip(      pos, end, param))) break;
         }
         param->src_x = sx;
@@ -763,11 +1184,10 @@ return;
 
     void pushColors_impl(std::int32_t length, pixelcopy_t* param) override
     {
-      auto k = _bitwidth * _write_conv.bits >> 3;
       std::int32_t linelength;
       do {
         linelength = std::min(_xe - _xptr + 1, length);
-        param->fp_copy(&_img[_yptr * k], _xptr, _xptr + linelength, param);
+        param->fp_copy(&_img[_row(_yptr) * _stride], _xptr, _xptr + linelength, param);
         ptr_advance(linelength);
       } while (length -= linelength);
     }
@@ -776,50 +1196,12 @@ return;
     void endTransaction_impl(void) override {}
     void waitDMA_impl(void) override {}
 
-    inline std::int32_t ptr_advance(std::int32_t length = 1) {
+    inline void ptr_advance(std::int32_t length = 1) {
       if ((_xptr += length) > _xe) {
         _xptr = _xs;
         if (++_yptr > _ye) {
           _yptr = _ys;
         }
-        return (_index = _xptr + _yptr * _bitwidth);
-      } else {
-        return (_index += length);
-      }
-    }
-
-    static void memset_multi(std::uint8_t* buf, std::uint32_t c, size_t size, size_t length)
-    {
-      size_t l = length;
-      if (l & ~0xF) {
-        while ((l >>= 1) & ~0xF);
-        ++l;
-      }
-      size_t len = l * size;
-      length = (length * size) - len;
-      std::uint8_t* dst = buf;
-      if (size == 2) {
-        do { // 2byte speed tweak
-          *(std::uint16_t*)dst = c;
-          dst += 2;
-        } while (--l);
-      } else {
-        do {
-          size_t i = 0;
-          do {
-            *dst++ = *(((std::uint8_t*)&c) + i);
-          } while (++i != size);
-        } while (--l);
-      }
-      if (!length) return;
-      while (length > len) {
-        memcpy(dst, buf, len);
-        dst += len;
-        length -= len;
-        len <<= 1;
-      }
-      if (length) {
-        memcpy(dst, buf, length);
       }
     }
 
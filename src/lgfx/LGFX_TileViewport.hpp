@@ -0,0 +1,398 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_TILEVIEWPORT_HPP_
+#define LGFX_TILEVIEWPORT_HPP_
+
+#include <algorithm>
+
+#include "LGFXBase.hpp"
+
+namespace lgfx
+{
+  // window on the display over a large tiled image file (maps, floor plans).
+  // decoded tiles are kept in a LRU cache, panning moves the drawn area with copyRect
+  // and draws only the newly exposed strips.
+  //
+  // file format (little endian) :
+  //   char          magic[4]   "LGTI"
+  //   std::uint32_t width
+  //   std::uint32_t height
+  //   std::uint16_t tile_size  (square tiles)
+  //   std::uint8_t  depth      (8 : rgb332 / 16 : rgb565 big endian / 24 : rgb888)
+  //   std::uint8_t  reserved
+  //   tile data : row-major tiles of tile_size * tile_size pixels (edge tiles are padded).
+  //
+  // tools/lgti_convert makes this file from a BMP or PNG image.
+  class LGFX_TileViewport
+  {
+  public:
+    static constexpr std::uint32_t header_size = 16;
+
+    LGFX_TileViewport(LovyanGFX* dst = nullptr) : _dst(dst) {}
+
+    virtual ~LGFX_TileViewport() { close(); }
+
+    // data must be valid until close().
+    bool open(DataWrapper* data)
+    {
+      close();
+      return open_data(data);
+    }
+
+#if defined (ARDUINO)
+ #if defined (FS_H) || defined (__SEEED_FS__)
+
+    bool open(fs::FS &fs, const char *path)
+    {
+      close();
+      if (!_file.open(fs, path, "r")) return false;
+      _file_opened = true;
+      if (open_data(&_file)) return true;
+      close();
+      return false;
+    }
+
+ #endif
+#elif defined (CONFIG_IDF_TARGET_ESP32)  || defined(__SAMD51_HARMONY__) || defined (LGFX_HOST) // ESP-IDF, Harmony or host
+
+    bool open(const char *path)
+    {
+      close();
+      if (!_file.open(path, "r")) return false;
+      _file_opened = true;
+      if (open_data(&_file)) return true;
+      close();
+      return false;
+    }
+
+#endif
+
+    void close(void)
+    {
+      free_cache();
+      if (_file_opened) {
+        _file.close();
+        _file_opened = false;
+      }
+      _data = nullptr;
+      _drawn = false;
+    }
+
+    void setTarget(LovyanGFX* dst) { _dst = dst; _drawn = false; prepare_read(); }
+
+    // area on the target. (default : whole target)
+    void setWindow(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) { _win_x = x; _win_y = y; _win_w = w; _win_h = h; _drawn = false; }
+
+    // memory budget of the tile cache in bytes. (at least one tile is kept)
+    void setCacheSize(std::uint32_t bytes) { _cache_size = bytes; if (_data) alloc_cache(); }
+
+    void setPsram( bool enabled ) { _psram = enabled; }
+
+    std::int32_t imageWidth(void) const { return _img_w; }
+    std::int32_t imageHeight(void) const { return _img_h; }
+    std::int32_t getX(void) const { return _src_x; }
+    std::int32_t getY(void) const { return _src_y; }
+
+    std::uint32_t cacheHits(void) const { return _hits; }
+    std::uint32_t cacheMisses(void) const { return _misses; }
+    std::uint32_t prefetchCount(void) const { return _prefetched; }
+
+    // redraw the whole window with the image position (x, y) at the top-left.
+    void drawAt(std::int32_t x, std::int32_t y)
+    {
+      if (!_data || !_dst) return;
+      update_window();
+      clamp_pos(x, y);
+      _src_x = x;
+      _src_y = y;
+      _dx = _dy = 0;
+      ++_tick;
+      draw_area(_win_x, _win_y, _win_w, _win_h);
+      _drawn = true;
+    }
+
+    // move to (x, y). the visible part is shifted with copyRect and only the exposed strips are drawn.
+    void panTo(std::int32_t x, std::int32_t y)
+    {
+      if (!_data || !_dst) return;
+      if (!_drawn) { drawAt(x, y); return; }
+      clamp_pos(x, y);
+      std::int32_t dx = x - _src_x;
+      std::int32_t dy = y - _src_y;
+      if (!dx && !dy) return;
+      std::int32_t adx = abs(dx);
+      std::int32_t ady = abs(dy);
+      if (adx >= _win_w || ady >= _win_h || !_dst->isReadable()) {
+        drawAt(x, y);
+      } else {
+        _src_x = x;
+        _src_y = y;
+        ++_tick;
+        std::int32_t cw = _win_w - adx;
+        std::int32_t ch = _win_h - ady;
+        _dst->copyRect(_win_x + std::max(0, -dx), _win_y + std::max(0, -dy), cw, ch
+                     , _win_x + std::max(0,  dx), _win_y + std::max(0,  dy));
+        std::int32_t sx = _win_x;   // columns not covered by the vertical strip
+        if (dx) {
+          std::int32_t vx = (dx > 0) ? _win_x + cw : _win_x;
+          draw_area(vx, _win_y, adx, _win_h);
+          if (dx < 0) sx += adx;
+        }
+        if (dy) {
+          draw_area(sx, (dy > 0) ? _win_y + ch : _win_y, cw, ady);
+        }
+      }
+      _dx = dx;
+      _dy = dy;
+      prefetch();
+    }
+
+    void panBy(std::int32_t dx, std::int32_t dy) { panTo(_src_x + dx, _src_y + dy); }
+
+    // read the tiles just beyond the window edge in the direction of the last move.
+    // tiles visible in the last draw are not evicted.
+    void prefetch(void)
+    {
+      if (!_data || !_drawn || (!_dx && !_dy)) return;
+      std::int32_t ahead_x = std::max<std::int32_t>(abs(_dx), 1);
+      std::int32_t ahead_y = std::max<std::int32_t>(abs(_dy), 1);
+      if (_dx) {
+        std::int32_t x = (_dx > 0) ? _src_x + _win_w : _src_x - ahead_x;
+        prefetch_area(x, _src_y, ahead_x, _win_h);
+      }
+      if (_dy) {
+        std::int32_t y = (_dy > 0) ? _src_y + _win_h : _src_y - ahead_y;
+        prefetch_area(_src_x, y, _win_w, ahead_y);
+      }
+    }
+
+  protected:
+
+    struct cache_slot_t
+    {
+      std::uint8_t* buf = nullptr;
+      std::int32_t index = -1;
+      std::uint32_t used = 0;
+    };
+
+    LovyanGFX* _dst;
+    DataWrapper* _data = nullptr;
+    FileWrapper _file;
+    cache_slot_t* _slots = nullptr;
+    std::uint32_t _slot_count = 0;
+    std::uint32_t _cache_size = 64 * 1024;
+    std::uint32_t _tick = 0;
+    std::uint32_t _hits = 0;
+    std::uint32_t _misses = 0;
+    std::uint32_t _prefetched = 0;
+    std::int32_t _img_w = 0;
+    std::int32_t _img_h = 0;
+    std::int32_t _tile_size = 0;
+    std::int32_t _tile_stride = 0;
+    std::int32_t _tile_cols = 0;
+    std::int32_t _win_x = 0;
+    std::int32_t _win_y = 0;
+    std::int32_t _win_w = 0;
+    std::int32_t _win_h = 0;
+    std::int32_t _src_x = 0;
+    std::int32_t _src_y = 0;
+    std::int32_t _dx = 0;   // last move
+    std::int32_t _dy = 0;
+    color_depth_t _depth = rgb565_2Byte;
+    bool _drawn = false;
+    bool _psram = false;
+    bool _file_opened = false;
+
+    std::uint32_t tile_length(void) const { return _tile_stride * _tile_size; }
+
+    bool alloc_cache(void)
+    {
+      free_cache();
+      _slot_count = std::max<std::uint32_t>(1, _cache_size / tile_length());
+      _slots = (cache_slot_t*)heap_alloc(_slot_count * sizeof(cache_slot_t));
+      if (_slots == nullptr) {
+        _slot_count = 0;
+        return false;
+      }
+      for (std::uint32_t i = 0; i < _slot_count; ++i) _slots[i] = cache_slot_t();
+      return true;
+    }
+
+    void free_cache(void)
+    {
+      if (_slots == nullptr) return;
+      for (std::uint32_t i = 0; i < _slot_count; ++i) {
+        if (_slots[i].buf) heap_free(_slots[i].buf);
+      }
+      heap_free(_slots);
+      _slots = nullptr;
+      _slot_count = 0;
+    }
+
+    void update_window(void)
+    {
+      if (_win_w > 0 && _win_h > 0) return;
+      _win_x = _win_y = 0;
+      _win_w = _dst->width();
+      _win_h = _dst->height();
+    }
+
+    void clamp_pos(std::int32_t& x, std::int32_t& y) const
+    {
+      x = std::max(0, std::min(x, _img_w - _win_w));
+      y = std::max(0, std::min(y, _img_h - _win_h));
+    }
+
+    // tile data from the cache, or read it into the least recently used slot.
+    // with prefetch, slots used in the current draw are kept.
+    const std::uint8_t* get_tile(std::int32_t index, bool prefetch = false)
+    {
+      cache_slot_t* victim = &_slots[0];
+      for (std::uint32_t i = 0; i < _slot_count; ++i) {
+        auto s = &_slots[i];
+        if (s->index == index) {
+          if (!prefetch) {
+            s->used = _tick;
+            ++_hits;
+          }
+          return s->buf;
+        }
+        if (s->used < victim->used) victim = s;
+      }
+      if (prefetch && victim->used == _tick) return nullptr;
+      if (victim->buf == nullptr) {
+        victim->buf = (std::uint8_t*)(_psram ? heap_alloc_psram(tile_length()) : heap_alloc(tile_length()));
+        if (victim->buf == nullptr) return nullptr;
+      }
+      if (prefetch) ++_prefetched;
+      else          ++_misses;
+      // a short or failed read leaves the slot empty. (the result of seek differs between the wrappers.)
+      victim->index = -1;
+      _data->preRead();
+      _data->seek(header_size + index * tile_length());
+      bool res = (std::int32_t)tile_length() == _data->read(victim->buf, tile_length());
+      _data->postRead();
+      if (!res) return nullptr;
+      victim->index = index;
+      victim->used = _tick;
+      return victim->buf;
+    }
+
+    void prefetch_area(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
+      std::int32_t xe = std::min(x + w, _img_w);
+      std::int32_t ye = std::min(y + h, _img_h);
+      x = std::max(0, x);
+      y = std::max(0, y);
+      if (x >= xe || y >= ye) return;
+      for (std::int32_t ty = y / _tile_size; ty <= (ye - 1) / _tile_size; ++ty) {
+        for (std::int32_t tx = x / _tile_size; tx <= (xe - 1) / _tile_size; ++tx) {
+          if (nullptr == get_tile(ty * _tile_cols + tx, true)) return;
+        }
+      }
+    }
+
+    bool open_data(DataWrapper* data)
+    {
+      _data = data;
+      prepare_read();
+      std::uint8_t magic[4];
+      std::uint8_t hdr[2];
+      data->preRead();
+      bool res = (4 == data->read(magic, 4)) && !memcmp(magic, "LGTI", 4);
+      if (res) {
+        _img_w = data->read32();
+        _img_h = data->read32();
+        _tile_size = data->read16();
+        data->read(hdr, 2);
+        _depth = (color_depth_t)hdr[0];
+      }
+      data->postRead();
+      if (!res || !_img_w || !_img_h || !_tile_size || (_depth != 8 && _depth != 16 && _depth != 24)) {
+        _data = nullptr;
+        return false;
+      }
+      _tile_stride = _tile_size * (_depth >> 3);
+      _tile_cols = (_img_w + _tile_size - 1) / _tile_size;
+      _drawn = false;
+      return alloc_cache();
+    }
+
+    // tile reads release the target's transaction when the file shares its SPI bus.
+    void prepare_read(void)
+    {
+      if (!_data) return;
+      _data->parent = nullptr;
+      _data->fp_pre_read = _data->fp_post_read = nullptr;
+      if (_dst) _dst->prepareTmpTransaction(_data);
+    }
+
+    // draw the window area (x, y, w, h) on the target.
+    void draw_area(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
+      if (w < 1 || h < 1) return;
+      std::int32_t ix = _src_x + x - _win_x;
+      std::int32_t iy = _src_y + y - _win_y;
+
+      // outside of the image.
+      std::uint32_t bg = _dst->getBaseColor();
+      if (ix + w > _img_w) {
+        std::int32_t n = std::min(w, ix + w - _img_w);
+        _dst->fillRect(x + w - n, y, n, h, bg);
+        if (0 == (w -= n)) return;
+      }
+      if (iy + h > _img_h) {
+        std::int32_t n = std::min(h, iy + h - _img_h);
+        _dst->fillRect(x, y + h - n, w, n, bg);
+        if (0 == (h -= n)) return;
+      }
+
+      pixelcopy_t p(nullptr, _dst->getColorDepth(), _depth, _dst->hasPalette());
+      std::int32_t bytes = _depth >> 3;
+      std::int32_t ox = x - ix;   // image to target offset
+      std::int32_t oy = y - iy;
+      std::int32_t ye = iy + h;
+      std::int32_t xe = ix + w;
+      do {
+        std::int32_t ty = iy / _tile_size;
+        std::int32_t ly = iy - ty * _tile_size;
+        std::int32_t th = std::min(ye - iy, _tile_size - ly);
+        std::int32_t px = ix;
+        do {
+          std::int32_t tx = px / _tile_size;
+          std::int32_t lx = px - tx * _tile_size;
+          std::int32_t tw = std::min(xe - px, _tile_size - lx);
+          auto tile = get_tile(ty * _tile_cols + tx);
+          if (tile) {
+            p.src_data = &tile[ly * _tile_stride + lx * bytes];
+            _dst->push_image(ox + px, oy + iy, tw, th, &p, false, _tile_stride);
+          }
+          px += tw;
+        } while (px < xe);
+        iy += th;
+      } while (iy < ye);
+    }
+  };
+
+}
+
+typedef lgfx::LGFX_TileViewport LGFX_TileViewport;
+
+#endif
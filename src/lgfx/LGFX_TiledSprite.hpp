@@ -0,0 +1,535 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_TILEDSPRITE_HPP_
+#define LGFX_TILEDSPRITE_HPP_
+
+#include <algorithm>
+
+#include "LGFXBase.hpp"
+
+namespace lgfx
+{
+  // sparse sprite for large virtual canvases.
+  // the area is divided into square tiles, a tile is allocated on the first write to it.
+  // untouched tiles are read as the base colour (setBaseColor).
+  // color depth : 8 / 16 / 24 bit.
+  class LGFX_TiledSprite : public LovyanGFX
+  {
+  public:
+
+    LGFX_TiledSprite(LovyanGFX* parent)
+    : LovyanGFX()
+    , _parent(parent)
+    {
+      _read_conv = _write_conv;
+      _spi_shared = false;
+      _transaction_count = 0xFFFF;
+    }
+
+    LGFX_TiledSprite()
+    : LGFX_TiledSprite(nullptr)
+    {}
+
+    virtual ~LGFX_TiledSprite() {
+      deleteSprite();
+    }
+
+    std::uint32_t getTileSize(void) const { return 1 << _tile_shift; }
+    std::uint32_t tileLength(void) const { return _tile_stride << _tile_shift; } // bytes per tile
+    std::uint32_t tileCount(void) const { return _tile_count; }                  // allocated tiles
+    std::uint32_t bufferLength(void) const { return _tile_count * tileLength(); }
+
+    // size : 8 - 256 pixels (rounded up to power of 2). call before createSprite.
+    void setTileSize(std::uint32_t size)
+    {
+      std::uint32_t shift = 3;
+      while (shift < 8 && (1u << shift) < size) ++shift;
+      _tile_shift = shift;
+    }
+
+    void setPsram( bool enabled )
+    {
+      _psram = enabled;
+    }
+
+    // release all tiles. the whole area returns to the base colour.
+    void clearTiles(void)
+    {
+      if (_tiles == nullptr) return;
+      std::uint32_t n = _tile_cols * _tile_rows;
+      for (std::uint32_t i = 0; i < n; ++i) {
+        if (_tiles[i] != nullptr) {
+          heap_free(_tiles[i]);
+          _tiles[i] = nullptr;
+        }
+      }
+      _tile_count = 0;
+    }
+
+    void deleteSprite(void)
+    {
+      clearTiles();
+      if (_tiles != nullptr) {
+        heap_free(_tiles);
+        _tiles = nullptr;
+      }
+      if (_bg_line != nullptr) {
+        heap_free(_bg_line);
+        _bg_line = nullptr;
+      }
+      _tile_cols = _tile_rows = 0;
+      _width = 0;
+      _height = 0;
+      _clip_l = 0;
+      _clip_t = 0;
+      _clip_r = -1;
+      _clip_b = -1;
+      _sw = 0;
+      _sh = 0;
+    }
+
+    // only the tile table is allocated here.
+    void* createSprite(std::int32_t w, std::int32_t h)
+    {
+      deleteSprite();
+      if (w < 1 || h < 1 || _write_conv.bits < 8) return nullptr;
+
+      std::int32_t mask = (1 << _tile_shift) - 1;
+      _tile_stride = _write_conv.bytes << _tile_shift;
+      _tile_cols = (w + mask) >> _tile_shift;
+      _tile_rows = (h + mask) >> _tile_shift;
+      size_t len = _tile_cols * _tile_rows * sizeof(std::uint8_t*);
+      _tiles = (std::uint8_t**)heap_alloc(len);
+      _bg_line = (std::uint8_t*)heap_alloc(_tile_stride << 1);
+      if (!_tiles || !_bg_line) {
+        deleteSprite();
+        return nullptr;
+      }
+      memset(_tiles, 0, len);
+      _bg_raw = ~0u;
+      update_bg();
+
+      _sw = _width = w;
+      _clip_r = _xe = w - 1;
+      _xpivot = w >> 1;
+
+      _sh = _height = h;
+      _clip_b = _ye = h - 1;
+      _ypivot = h >> 1;
+
+      _clip_l = _clip_t = _sx = _sy = _xs = _ys = _xptr = _yptr = 0;
+
+      return _tiles;
+    }
+
+    __attribute__ ((always_inline)) inline void* setColorDepth(std::uint8_t bpp) { return setColorDepth((color_depth_t)bpp); }
+    void* setColorDepth(color_depth_t depth)
+    {
+      _write_conv.setColorDepth(depth);
+      _read_conv = _write_conv;
+
+      if (_tiles == nullptr) return nullptr;
+      return createSprite(_width, _height);
+    }
+
+    std::uint32_t readPixelValue(std::int32_t x, std::int32_t y)
+    {
+      auto t = _tile(x, y);
+      if (t == nullptr) {
+        update_bg();
+        return _bg_raw;
+      }
+      t += tile_offset(x, y);
+      auto bytes = _read_conv.bytes;
+      return (bytes == 1) ? t[0]
+           : (bytes == 2) ? *(std::uint16_t*)t
+                          : (std::uint32_t)*(bgr888_t*)t;
+    }
+
+    template<typename T>
+    __attribute__ ((always_inline)) inline void fillSprite (const T& color) { fillRect(0, 0, _width, _height, color); }
+
+    template<typename T>
+    __attribute__ ((always_inline)) inline void pushSprite(                std::int32_t x, std::int32_t y, const T& transp) { push_sprite(_parent, x, y, 0, 0, _width, _height, _write_conv.convert(transp) & _write_conv.colormask); }
+    template<typename T>
+    __attribute__ ((always_inline)) inline void pushSprite(LovyanGFX* dst, std::int32_t x, std::int32_t y, const T& transp) { push_sprite(    dst, x, y, 0, 0, _width, _height, _write_conv.convert(transp) & _write_conv.colormask); }
+    __attribute__ ((always_inline)) inline void pushSprite(                std::int32_t x, std::int32_t y) { push_sprite(_parent, x, y, 0, 0, _width, _height); }
+    __attribute__ ((always_inline)) inline void pushSprite(LovyanGFX* dst, std::int32_t x, std::int32_t y) { push_sprite(    dst, x, y, 0, 0, _width, _height); }
+
+    // push the area (src_x, src_y, w, h) of the canvas to (x, y).
+    template<typename T>
+    __attribute__ ((always_inline)) inline void pushViewport(                std::int32_t x, std::int32_t y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, const T& transp) { push_sprite(_parent, x, y, src_x, src_y, w, h, _write_conv.convert(transp) & _write_conv.colormask); }
+    template<typename T>
+    __attribute__ ((always_inline)) inline void pushViewport(LovyanGFX* dst, std::int32_t x, std::int32_t y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, const T& transp) { push_sprite(    dst, x, y, src_x, src_y, w, h, _write_conv.convert(transp) & _write_conv.colormask); }
+    __attribute__ ((always_inline)) inline void pushViewport(                std::int32_t x, std::int32_t y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h) { push_sprite(_parent, x, y, src_x, src_y, w, h); }
+    __attribute__ ((always_inline)) inline void pushViewport(LovyanGFX* dst, std::int32_t x, std::int32_t y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h) { push_sprite(    dst, x, y, src_x, src_y, w, h); }
+
+//----------------------------------------------------------------------------
+
+  protected:
+    LovyanGFX* _parent;
+    std::uint8_t** _tiles = nullptr;  // tile table (nullptr : not allocated)
+    std::uint8_t* _bg_line = nullptr; // one tile row of the base colour, then one work row
+    std::uint32_t _bg_raw = ~0u;
+    std::uint32_t _tile_shift = 6;    // 64 x 64 pixels
+    std::uint32_t _tile_stride = 0;   // bytes per tile row
+    std::uint32_t _tile_cols = 0;
+    std::uint32_t _tile_rows = 0;
+    std::uint32_t _tile_count = 0;
+    std::int32_t _xptr = 0;
+    std::int32_t _yptr = 0;
+    std::int32_t _xs = 0;
+    std::int32_t _xe = 0;
+    std::int32_t _ys = 0;
+    std::int32_t _ye = 0;
+    bool _psram = false;
+
+    __attribute__ ((always_inline)) inline std::uint8_t*& _tile(std::int32_t x, std::int32_t y)
+    {
+      return _tiles[(y >> _tile_shift) * _tile_cols + (x >> _tile_shift)];
+    }
+
+    __attribute__ ((always_inline)) inline std::uint32_t tile_offset(std::int32_t x, std::int32_t y) const
+    {
+      std::int32_t mask = (1 << _tile_shift) - 1;
+      return (y & mask) * _tile_stride + (x & mask) * _write_conv.bytes;
+    }
+
+    // tile of (x, y). allocate and fill with the base colour on first use.
+    std::uint8_t* get_tile(std::int32_t x, std::int32_t y)
+    {
+      auto& t = _tile(x, y);
+      if (t == nullptr) {
+        update_bg();
+        t = (std::uint8_t*)(_psram ? heap_alloc_psram(tileLength()) : heap_alloc(tileLength()));
+        if (t == nullptr) return nullptr;
+        ++_tile_count;
+        std::int32_t i = 1 << _tile_shift;
+        auto dst = t;
+        do {
+          memcpy(dst, _bg_line, _tile_stride);
+          dst += _tile_stride;
+        } while (--i);
+      }
+      return t;
+    }
+
+    void update_bg(void)
+    {
+      std::uint32_t raw = _write_conv.convert_rgb888(_base_rgb888) & _write_conv.colormask;
+      if (_bg_raw == raw) return;
+      _bg_raw = raw;
+      memset_multi(_bg_line, raw, _write_conv.bytes, 1 << _tile_shift);
+    }
+
+    // split the rect at the tile boundaries.
+    template<typename TFunc>
+    void tile_iterate(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, TFunc fn)
+    {
+      std::int32_t mask = (1 << _tile_shift) - 1;
+      std::int32_t xe = x + w;
+      std::int32_t ye = y + h;
+      do {
+        std::int32_t ph = std::min(ye, (y | mask) + 1) - y;
+        std::int32_t px = x;
+        do {
+          std::int32_t pw = std::min(xe, (px | mask) + 1) - px;
+          fn(px, y, pw, ph);
+          px += pw;
+        } while (px < xe);
+        y += ph;
+      } while (y < ye);
+    }
+
+    void fill_rect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+    {
+      update_bg();
+      std::uint32_t color = _color.raw & _write_conv.colormask;
+      std::uint32_t bytes = _write_conv.bytes;
+      std::int32_t tile_size = 1 << _tile_shift;
+      bool is_bg = (color == _bg_raw);
+      tile_iterate(x, y, w, h, [&](std::int32_t px, std::int32_t py, std::int32_t pw, std::int32_t ph)
+      {
+        auto& t = _tile(px, py);
+        if (is_bg) {
+          if (t == nullptr) return;
+          if (pw == std::min(tile_size, _width  - (px & ~(tile_size - 1)))
+           && ph == std::min(tile_size, _height - (py & ~(tile_size - 1)))) {
+            heap_free(t);  // whole tile is the base colour again.
+            t = nullptr;
+            --_tile_count;
+            return;
+          }
+        }
+        auto dst = get_tile(px, py);
+        if (dst == nullptr) return;
+        dst += tile_offset(px, py);
+        do {
+          memset_multi(dst, color, bytes, pw);
+          dst += _tile_stride;
+        } while (--ph);
+      });
+    }
+
+    void read_line(std::int32_t x, std::int32_t y, std::int32_t w, std::uint8_t* buf)
+    {
+      std::uint32_t bytes = _write_conv.bytes;
+      tile_iterate(x, y, w, 1, [&](std::int32_t px, std::int32_t py, std::int32_t pw, std::int32_t)
+      {
+        auto t = _tile(px, py);
+        memcpy(buf, t ? &t[tile_offset(px, py)] : _bg_line, pw * bytes);
+        buf += pw * bytes;
+      });
+    }
+
+    void write_line(std::int32_t x, std::int32_t y, std::int32_t w, const std::uint8_t* buf)
+    {
+      std::uint32_t bytes = _write_conv.bytes;
+      tile_iterate(x, y, w, 1, [&](std::int32_t px, std::int32_t py, std::int32_t pw, std::int32_t)
+      {
+        std::uint32_t len = pw * bytes;
+        auto t = _tile(px, py);
+        if (t || memcmp(buf, _bg_line, len)) {  // keep the untouched tiles.
+          if (nullptr != (t = get_tile(px, py))) memcpy(&t[tile_offset(px, py)], buf, len);
+        }
+        buf += len;
+      });
+    }
+
+    void copy_line(std::int32_t x, std::int32_t y, std::int32_t w, pixelcopy_t* param)
+    {
+      std::int32_t mask = (1 << _tile_shift) - 1;
+      tile_iterate(x, y, w, 1, [&](std::int32_t px, std::int32_t py, std::int32_t pw, std::int32_t)
+      {
+        std::int32_t pos = px & mask;
+        std::int32_t end = pos + pw;
+        auto t = _tile(px, py);
+        if (t == nullptr) {
+          // the row goes to the work row first. when it is all base colour, no tile is allocated.
+          update_bg();
+          std::uint32_t bytes = _write_conv.bytes;
+          std::uint32_t ofs = pos * bytes;
+          std::uint32_t len = pw * bytes;
+          auto work = &_bg_line[_tile_stride];
+          memcpy(&work[ofs], &_bg_line[ofs], len);
+          while (end != (pos = param->fp_copy(work, pos, end, param))) {
+            if ( end == (pos = param->fp_skip(      pos, end, param))) break;
+          }
+          if (!memcmp(&work[ofs], &_bg_line[ofs], len)) return;
+          if (nullptr != (t = get_tile(px, py))) memcpy(&t[(py & mask) * _tile_stride + ofs], &work[ofs], len);
+          return;
+        }
+        auto line = &t[(py & mask) * _tile_stride];
+        while (end != (pos = param->fp_copy(line, pos, end, param))) {
+          if ( end == (pos = param->fp_skip(      pos, end, param))) break;
+        }
+      });
+    }
+
+    void push_sprite(LovyanGFX* dst, std::int32_t x, std::int32_t y, std::int32_t src_x, std::int32_t src_y, std::int32_t w, std::int32_t h, std::uint32_t transp = ~0)
+    {
+      if (src_x < 0) { x -= src_x; w += src_x; src_x = 0; }
+      if (src_y < 0) { y -= src_y; h += src_y; src_y = 0; }
+      w = std::min(w, _width  - src_x);
+      h = std::min(h, _height - src_y);
+      if (w < 1 || h < 1) return;
+
+      update_bg();
+      bool fill_bg = (transp == ~0u || transp != _bg_raw);
+      std::uint32_t bg_rgb888;
+      {
+        bgr888_t c;
+        pixelcopy_t pc(_bg_line, rgb888_3Byte, getColorDepth());
+        pc.fp_copy(&c, 0, 1, &pc);
+        bg_rgb888 = c.r << 16 | c.g << 8 | c.b;
+      }
+      pixelcopy_t p(nullptr, dst->getColorDepth(), getColorDepth(), dst->hasPalette(), nullptr, transp);
+      x -= src_x;
+      y -= src_y;
+      std::int32_t mask = (1 << _tile_shift) - 1;
+      std::int32_t xe = src_x + w;
+      std::int32_t ye = src_y + h;
+      std::int32_t ty = src_y;
+      dst->startWrite();
+      do {
+        std::int32_t th = std::min(ye, (ty | mask) + 1) - ty;
+        std::int32_t run = src_x;   // start of the untouched tiles run
+        std::int32_t tx = src_x;
+        do {
+          std::int32_t tw = std::min(xe, (tx | mask) + 1) - tx;
+          auto t = _tile(tx, ty);
+          if (t != nullptr) {
+            if (fill_bg && run != tx) dst->fillRect(x + run, y + ty, tx - run, th, bg_rgb888);
+            p.src_data = &t[tile_offset(tx, ty)];
+            dst->push_image(x + tx, y + ty, tw, th, &p, false, _tile_stride);
+            run = tx + tw;
+          }
+          tx += tw;
+        } while (tx < xe);
+        if (fill_bg && run != xe) dst->fillRect(x + run, y + ty, xe - run, th, bg_rgb888);
+        ty += th;
+      } while (ty < ye);
+      dst->endWrite();
+    }
+
+    void set_window(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye)
+    {
+      if (xs > xe) std::swap(xs, xe);
+      if (ys > ye) std::swap(ys, ye);
+      if ((xe < 0) || (ye < 0) || (xs >= _width) || (ys >= _height))
+      {
+        _xptr = _xs = _xe = 0;
+        _yptr = _ys = _ye = _height;
+      } else {
+        _xptr = _xs = (xs < 0) ? 0 : xs;
+        _yptr = _ys = (ys < 0) ? 0 : ys;
+        _xe = std::min(xe, _width  - 1);
+        _ye = std::min(ye, _height - 1);
+      }
+    }
+
+    void setWindow_impl(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye) override
+    {
+      set_window(xs, ys, xe, ye);
+    }
+
+    void drawPixel_impl(std::int32_t x, std::int32_t y) override
+    {
+      auto t = _tile(x, y);
+      if (t == nullptr) {
+        update_bg();
+        if ((_color.raw & _write_conv.colormask) == _bg_raw) return;
+        if (nullptr == (t = get_tile(x, y))) return;
+      }
+      t += tile_offset(x, y);
+      auto bytes = _write_conv.bytes;
+      if (bytes == 1) {
+        t[0] = _color.raw0;
+      } else if (bytes == 2) {
+        *(std::uint16_t*)t = _color.rawL;
+      } else {
+        *(bgr888_t*)t = *(bgr888_t*)&_color;
+      }
+    }
+
+    void writeFillRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) override
+    {
+      fill_rect(x, y, w, h);
+    }
+
+    void pushBlock_impl(std::int32_t length) override
+    {
+      if (_yptr >= _height) return;
+      std::int32_t ll;
+      do {
+        ll = std::min(_xe - _xptr + 1, length);
+        fill_rect(_xptr, _yptr, ll, 1);
+        ptr_advance(ll);
+      } while (length -= ll);
+    }
+
+    void copyRect_impl(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y) override
+    {
+      update_bg();
+      auto buf = (std::uint8_t*)heap_alloc(w * _write_conv.bytes);
+      if (buf == nullptr) return;
+      std::int32_t add_y = (src_y < dst_y) ? -1 : 1;
+      if (add_y < 0) {
+        src_y += h - 1;
+        dst_y += h - 1;
+      }
+      do {
+        read_line(src_x, src_y, w, buf);
+        write_line(dst_x, dst_y, w, buf);
+        src_y += add_y;
+        dst_y += add_y;
+      } while (--h);
+      heap_free(buf);
+    }
+
+    void readRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, void* dst, pixelcopy_t* param) override
+    {
+      update_bg();
+      std::int32_t mask = (1 << _tile_shift) - 1;
+      std::int32_t dstindex = 0;
+      h += y;
+      do {
+        tile_iterate(x, y, w, 1, [&](std::int32_t px, std::int32_t py, std::int32_t pw, std::int32_t)
+        {
+          auto t = _tile(px, py);
+          if (t != nullptr) {
+            param->src_data = t;
+            param->src_stride = _tile_stride;
+            param->src_x = px & mask;
+            param->src_y = py & mask;
+          } else {
+            param->src_data = _bg_line;
+            param->src_stride = 0;
+            param->src_x = 0;
+            param->src_y = 0;
+          }
+          dstindex = param->fp_copy(dst, dstindex, dstindex + pw, param);
+        });
+      } while (++y != h);
+    }
+
+    void pushImage_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t* param, bool) override
+    {
+      auto sx = param->src_x;
+      do {
+        copy_line(x, y++, w, param);
+        param->src_x = sx;
+        param->src_y++;
+      } while (--h);
+    }
+
+    void pushColors_impl(std::int32_t length, pixelcopy_t* param) override
+    {
+      if (_yptr >= _height) return;
+      std::int32_t linelength;
+      do {
+        linelength = std::min(_xe - _xptr + 1, length);
+        copy_line(_xptr, _yptr, linelength, param);
+        ptr_advance(linelength);
+      } while (length -= linelength);
+    }
+
+    void beginTransaction_impl(void) override {}
+    void endTransaction_impl(void) override {}
+    void waitDMA_impl(void) override {}
+
+    inline void ptr_advance(std::int32_t length = 1) {
+      if ((_xptr += length) > _xe) {
+        _xptr = _xs;
+        if (++_yptr > _ye) {
+          _yptr = _ys;
+        }
+      }
+    }
+
+    bool isReadable_impl(void) const { return true; }
+    std::int_fast8_t getRotation_impl(void) const { return 0; }
+  };
+
+}
+
+typedef lgfx::LGFX_TiledSprite LGFX_TiledSprite;
+
+#endif
@@ -0,0 +1,64 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_BUSCOMMON_HPP_
+#define LGFX_BUSCOMMON_HPP_
+
+#include <cstdint>
+
+namespace lgfx
+{
+  // transport of the panel protocol. (see LGFX_Device)
+  // the bytes of data are sent from the lowest byte. (the order of the pixel bytes in memory)
+  struct BusCommon
+  {
+    virtual ~BusCommon() {}
+
+    virtual void init(void) {}
+
+    virtual void beginTransaction(void) {}
+    virtual void endTransaction(void) {}
+
+    // command byte. (dc low)
+    virtual void writeCommand(std::uint32_t data, std::uint32_t bit_length) = 0;
+
+    // parameter or pixel data. (dc high)
+    virtual void writeData(std::uint32_t data, std::uint32_t bit_length) = 0;
+
+    // the same pixel data count times.
+    virtual void writeDataRepeat(std::uint32_t data, std::uint32_t bit_length, std::uint32_t count) = 0;
+
+    // bulk data. when use_dma, the transfer may continue after return, data must be kept until wait().
+    // a write waits for the previous transfer before it starts.
+    virtual void writeBytes(const std::uint8_t* data, std::uint32_t length, bool use_dma) = 0;
+
+    // wait for the end of the transfer.
+    virtual void wait(void) {}
+    virtual bool busy(void) const { return false; }
+
+    virtual void beginRead(void) {}
+    virtual void endRead(void) {}
+    virtual std::uint32_t readData(std::uint32_t bit_length) = 0;
+    virtual void readBytes(std::uint8_t* dst, std::uint32_t length) = 0;
+  };
+
+//----------------------------------------------------------------------------
+}
+
+#endif
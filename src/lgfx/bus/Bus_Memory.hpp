@@ -0,0 +1,186 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_BUS_MEMORY_HPP_
+#define LGFX_BUS_MEMORY_HPP_
+
+#include "BusCommon.hpp"
+#include "../lgfx_common.hpp"
+
+namespace lgfx
+{
+  // records the bus traffic into memory. (for the host build and profiling of the panel protocol)
+  // each byte is logged as (type << 8 | value), the counters are kept after the log is full.
+  class Bus_Memory : public BusCommon
+  {
+  public:
+    enum record_type_t : std::uint8_t
+    { rec_command = 1
+    , rec_data    = 2
+    , rec_read    = 3
+    };
+
+    struct stats_t
+    {
+      std::uint32_t transactions = 0;
+      std::uint32_t commands     = 0;
+      std::uint32_t repeat_calls = 0;   // writeDataRepeat
+      std::uint32_t bulk_calls   = 0;   // writeBytes
+      std::uint32_t dma_calls    = 0;   // writeBytes with use_dma
+      std::uint32_t waits        = 0;
+      std::uint64_t write_bytes  = 0;   // commands and data
+      std::uint64_t read_bytes   = 0;
+    };
+
+    Bus_Memory(std::uint32_t capacity = 0) { setCapacity(capacity); }
+
+    virtual ~Bus_Memory() { if (_log) heap_free(_log); }
+
+    // max entries of the log. (0 : counters only)
+    bool setCapacity(std::uint32_t capacity)
+    {
+      if (_log) heap_free(_log);
+      _log = nullptr;
+      _capacity = 0;
+      if (capacity) {
+        _log = (std::uint16_t*)heap_alloc(capacity * sizeof(std::uint16_t));
+        if (!_log) return false;
+        _capacity = capacity;
+      }
+      clear();
+      return true;
+    }
+
+    void clear(void)
+    {
+      _length = 0;
+      _overflow = false;
+      _stats = stats_t();
+    }
+
+    const std::uint16_t* getLog(void) const { return _log; }
+    std::uint32_t getLogLength(void) const { return _length; }
+    bool isOverflow(void) const { return _overflow; }
+    const stats_t& getStats(void) const { return _stats; }
+
+    // bytes returned by the reads, repeated. (nullptr : zero)
+    void setReadData(const std::uint8_t* data, std::uint32_t length)
+    {
+      _read_data = length ? data : nullptr;
+      _read_length = length;
+      _read_index = 0;
+    }
+
+    void beginTransaction(void) override { ++_stats.transactions; }
+
+    void writeCommand(std::uint32_t data, std::uint32_t bit_length) override
+    {
+      ++_stats.commands;
+      write_value(rec_command, data, bit_length);
+    }
+
+    void writeData(std::uint32_t data, std::uint32_t bit_length) override
+    {
+      write_value(rec_data, data, bit_length);
+    }
+
+    void writeDataRepeat(std::uint32_t data, std::uint32_t bit_length, std::uint32_t count) override
+    {
+      ++_stats.repeat_calls;
+      std::uint32_t bytes = (bit_length + 7) >> 3;
+      while (count && _length + bytes <= _capacity) {
+        write_value(rec_data, data, bit_length);
+        --count;
+      }
+      if (count) {
+        _overflow = true;
+        _stats.write_bytes += (std::uint64_t)bytes * count;
+      }
+    }
+
+    void writeBytes(const std::uint8_t* data, std::uint32_t length, bool use_dma) override
+    {
+      ++_stats.bulk_calls;
+      if (use_dma) ++_stats.dma_calls;
+      _stats.write_bytes += length;
+      for (std::uint32_t i = 0; i < length; ++i) record(rec_data, data[i]);
+    }
+
+    void wait(void) override { ++_stats.waits; }
+
+    // byte granular, a read of 1 bit takes a byte.
+    std::uint32_t readData(std::uint32_t bit_length) override
+    {
+      std::uint32_t res = 0;
+      std::uint32_t bytes = (bit_length + 7) >> 3;
+      for (std::uint32_t i = 0; i < bytes; ++i) {
+        res |= (std::uint32_t)read_byte() << (i << 3);
+      }
+      return bit_length < 32 ? res & ((1u << bit_length) - 1) : res;
+    }
+
+    void readBytes(std::uint8_t* dst, std::uint32_t length) override
+    {
+      for (std::uint32_t i = 0; i < length; ++i) dst[i] = read_byte();
+    }
+
+  protected:
+    void record(std::uint_fast8_t type, std::uint_fast8_t value)
+    {
+      if (_length < _capacity) _log[_length++] = type << 8 | value;
+      else _overflow = true;
+    }
+
+    void write_value(std::uint_fast8_t type, std::uint32_t data, std::uint32_t bit_length)
+    {
+      std::uint32_t bytes = (bit_length + 7) >> 3;
+      _stats.write_bytes += bytes;
+      for (std::uint32_t i = 0; i < bytes; ++i) {
+        record(type, data >> (i << 3));
+      }
+    }
+
+    std::uint8_t read_byte(void)
+    {
+      ++_stats.read_bytes;
+      std::uint8_t res = 0;
+      if (_read_data) {
+        res = _read_data[_read_index];
+        if (++_read_index == _read_length) _read_index = 0;
+      }
+      record(rec_read, res);
+      return res;
+    }
+
+    std::uint16_t* _log = nullptr;
+    std::uint32_t _capacity = 0;
+    std::uint32_t _length = 0;
+    bool _overflow = false;
+    stats_t _stats;
+    const std::uint8_t* _read_data = nullptr;
+    std::uint32_t _read_length = 0;
+    std::uint32_t _read_index = 0;
+  };
+
+//----------------------------------------------------------------------------
+}
+
+typedef lgfx::Bus_Memory Bus_Memory;
+
+#endif
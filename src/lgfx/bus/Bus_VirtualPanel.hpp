@@ -0,0 +1,384 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_BUS_VIRTUALPANEL_HPP_
+#define LGFX_BUS_VIRTUALPANEL_HPP_
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "Bus_Memory.hpp"
+#include "../panel/PanelCommon.hpp"
+
+namespace lgfx
+{
+  // emulates the panel on the other side of the bus, for the host build.
+  // interprets the Ilitek style command stream (CASET / RASET / RAMWR / RAMRD / MADCTL / COLMOD
+  // / VSCRDEF / VSCRSADD / INVON / INVOFF) into a 18bit frame memory, and counts the traffic.
+  // (the log and the byte counters of Bus_Memory are kept as well)
+  // the frame is seen in the scan order of the memory, [offset, offset + panel size) of the panel.
+  class Bus_VirtualPanel : public Bus_Memory
+  {
+  public:
+    struct panel_stats_t
+    {
+      std::uint32_t commands[256];  // by command byte
+      std::uint32_t caset = 0;      // window changes
+      std::uint32_t raset = 0;
+      std::uint64_t pixels_written = 0;
+      std::uint64_t pixels_read    = 0;
+    };
+
+    Bus_VirtualPanel(std::uint32_t log_capacity = 0) : Bus_Memory(log_capacity) { clearPanelStats(); }
+
+    virtual ~Bus_VirtualPanel() { if (_mem) heap_free(_mem); }
+
+    // memory and visible area of the panel. (call before init)
+    bool setPanel(const PanelCommon* panel)
+    {
+      _panel_width  = panel->panel_width;
+      _panel_height = panel->panel_height;
+      _offset_x = panel->offset_x;
+      _offset_y = panel->offset_y;
+      _panel_bgr    = !panel->rgb_order;
+      _panel_invert =  panel->invert;
+      _read_dummy   = panel->len_dummy_read_pixel;
+      _rddid_dummy  = panel->len_dummy_read_rddid;
+      return setMemorySize(panel->memory_width, panel->memory_height);
+    }
+
+    bool setMemorySize(std::int32_t w, std::int32_t h)
+    {
+      if (_mem) heap_free(_mem);
+      _mem = (std::uint8_t*)heap_alloc(w * h * 3);
+      if (!_mem) {
+        _mem_width = _mem_height = 0;
+        return false;
+      }
+      memset(_mem, 0, w * h * 3);
+      _mem_width  = w;
+      _mem_height = h;
+      if (_panel_width  > w || !_panel_width ) _panel_width  = w;
+      if (_panel_height > h || !_panel_height) _panel_height = h;
+      reset();
+      return true;
+    }
+
+    // id returned by RDDID, from the lowest byte.
+    void setPanelID(std::uint32_t id) { _id = id; }
+
+    // state of the controller after the hardware reset. (the frame memory is kept)
+    void reset(void)
+    {
+      _cmd = 0;
+      _argc = 0;
+      _madctl = 0;
+      _pixel_bytes = 2;
+      _invon = false;
+      _xs = _ys = 0;
+      _xe = _mem_width - 1;
+      _ye = _mem_height - 1;
+      _tfa = _bfa = 0;
+      _vsa = _mem_height;
+      _vsp = 0;
+    }
+
+    std::int32_t width(void) const { return _panel_width; }
+    std::int32_t height(void) const { return _panel_height; }
+
+    // 0xRRGGBB of the visible pixel, as shown by the panel.
+    std::uint32_t readPixelRGB(std::int32_t x, std::int32_t y) const
+    {
+      auto p = &_mem[(scan_row(y + _offset_y) * _mem_width + x + _offset_x) * 3];
+      std::uint32_t r = p[0], g = p[1], b = p[2];
+      if (_panel_bgr != ((_madctl & 0x08) != 0)) std::swap(r, b);
+      std::uint32_t res = (r << 2 | r >> 4) << 16 | (g << 2 | g >> 4) << 8 | (b << 2 | b >> 4);
+      return (_invon != _panel_invert) ? res ^ 0xFFFFFF : res;
+    }
+
+    // binary PPM of the visible area.
+    bool writePPM(const char* path) const
+    {
+      auto fp = fopen(path, "wb");
+      if (!fp) return false;
+      fprintf(fp, "P6\n%d %d\n255\n", (int)_panel_width, (int)_panel_height);
+      // the rows are written in pieces of 64 pixels.
+      std::uint8_t buf[64 * 3];
+      bool res = true;
+      for (std::int32_t y = 0; y < _panel_height; ++y) {
+        for (std::int32_t x = 0; x < _panel_width; x += 64) {
+          std::int32_t n = std::min<std::int32_t>(64, _panel_width - x);
+          for (std::int32_t i = 0; i < n; ++i) {
+            auto c = readPixelRGB(x + i, y);
+            buf[i * 3    ] = c >> 16;
+            buf[i * 3 + 1] = c >>  8;
+            buf[i * 3 + 2] = c;
+          }
+          res &= (std::size_t)n == fwrite(buf, 3, n, fp);
+        }
+      }
+      return (0 == fclose(fp)) && res;
+    }
+
+    const panel_stats_t& getPanelStats(void) const { return _panel_stats; }
+
+    void clearPanelStats(void)
+    {
+      _panel_stats = panel_stats_t();
+      memset(_panel_stats.commands, 0, sizeof(_panel_stats.commands));
+    }
+
+    void writeCommand(std::uint32_t data, std::uint32_t bit_length) override
+    {
+      Bus_Memory::writeCommand(data, bit_length);
+      command(data >> (bit_length - 8));
+    }
+
+    void writeData(std::uint32_t data, std::uint32_t bit_length) override
+    {
+      Bus_Memory::writeData(data, bit_length);
+      for (std::uint32_t i = 0; i < bit_length; i += 8) parameter(data >> i);
+    }
+
+    void writeDataRepeat(std::uint32_t data, std::uint32_t bit_length, std::uint32_t count) override
+    {
+      Bus_Memory::writeDataRepeat(data, bit_length, count);
+      while (count--) {
+        for (std::uint32_t i = 0; i < bit_length; i += 8) parameter(data >> i);
+      }
+    }
+
+    void writeBytes(const std::uint8_t* data, std::uint32_t length, bool use_dma) override
+    {
+      Bus_Memory::writeBytes(data, length, use_dma);
+      for (std::uint32_t i = 0; i < length; ++i) parameter(data[i]);
+    }
+
+    // the bits are read MSB first, the bytes are stored from the lowest byte.
+    std::uint32_t readData(std::uint32_t bit_length) override
+    {
+      std::uint32_t res = 0;
+      for (std::uint32_t i = 0; i < bit_length; ++i) {
+        res |= read_bit() << ((i & ~7) + 7 - (i & 7));
+      }
+      for (std::uint32_t i = 0; i < bit_length; i += 8) {
+        ++_stats.read_bytes;
+        record(rec_read, res >> i);
+      }
+      return res;
+    }
+
+    void readBytes(std::uint8_t* dst, std::uint32_t length) override
+    {
+      while (length--) *dst++ = readData(8);
+    }
+
+  protected:
+    enum command_t : std::uint8_t
+    { cmd_swreset  = 0x01
+    , cmd_rddid    = 0x04
+    , cmd_invoff   = 0x20
+    , cmd_invon    = 0x21
+    , cmd_caset    = 0x2A
+    , cmd_raset    = 0x2B
+    , cmd_ramwr    = 0x2C
+    , cmd_ramrd    = 0x2E
+    , cmd_vscrdef  = 0x33
+    , cmd_madctl   = 0x36
+    , cmd_vscrsadd = 0x37
+    , cmd_colmod   = 0x3A
+    };
+
+    std::int32_t scan_row(std::int32_t y) const
+    {
+      if (y < _tfa || y >= _tfa + _vsa) return y;
+      y += _vsp - _tfa;
+      return (y < _tfa + _vsa) ? y : y - _vsa;
+    }
+
+    void command(std::uint8_t cmd)
+    {
+      end_command();
+      ++_panel_stats.commands[cmd];
+      _argc = 0;
+      _rd_bit = 0;
+      switch (cmd) {
+      case cmd_swreset: reset(); break;
+      case cmd_invoff: _invon = false; break;
+      case cmd_invon:  _invon = true;  break;
+      case cmd_ramwr:
+      case cmd_ramrd:
+        _col = _xs;
+        _row = _ys;
+        break;
+      default: break;
+      }
+      _cmd = cmd;
+    }
+
+    // 2 bytes window of the 8bit address panels.
+    void end_command(void)
+    {
+      if (_argc != 2) return;
+      if (_cmd == cmd_caset) { _xs = _args[0]; _xe = _args[1]; }
+      if (_cmd == cmd_raset) { _ys = _args[0]; _ye = _args[1]; }
+    }
+
+    void parameter(std::uint8_t value)
+    {
+      if (_cmd == cmd_ramwr) {
+        _args[_argc] = value;
+        if (++_argc == _pixel_bytes) {
+          _argc = 0;
+          write_pixel();
+        }
+        return;
+      }
+      if (_argc < sizeof(_args)) _args[_argc] = value;
+      ++_argc;
+      switch (_cmd) {
+      case cmd_caset:
+        if (_argc == 4) { _xs = _args[0] << 8 | _args[1]; _xe = _args[2] << 8 | _args[3]; ++_panel_stats.caset; }
+        break;
+      case cmd_raset:
+        if (_argc == 4) { _ys = _args[0] << 8 | _args[1]; _ye = _args[2] << 8 | _args[3]; ++_panel_stats.raset; }
+        break;
+      case cmd_madctl:
+        _madctl = value;
+        break;
+      case cmd_colmod:
+        _pixel_bytes = ((value & 7) == 5) ? 2 : 3;
+        break;
+      case cmd_vscrdef:
+        if (_argc == 6) {
+          _tfa = _args[0] << 8 | _args[1];
+          _vsa = _args[2] << 8 | _args[3];
+          _bfa = _args[4] << 8 | _args[5];
+          if (_tfa + _vsa + _bfa != _mem_height) { _tfa = 0; _vsa = _mem_height; }  // ignored by the panel
+        }
+        break;
+      case cmd_vscrsadd:
+        if (_argc == 2) _vsp = _args[0] << 8 | _args[1];
+        break;
+      default: break;
+      }
+    }
+
+    // memory address of the address counter. (MV exchanges, then MX / MY mirror the memory axes)
+    std::uint8_t* pixel_address(void) const
+    {
+      std::int32_t x = _col;
+      std::int32_t y = _row;
+      if (_madctl & 0x20) std::swap(x, y);
+      if (_madctl & 0x40) x = _mem_width  - 1 - x;
+      if (_madctl & 0x80) y = _mem_height - 1 - y;
+      if (x < 0 || x >= _mem_width || y < 0 || y >= _mem_height) return nullptr;
+      return &_mem[(y * _mem_width + x) * 3];
+    }
+
+    void next_address(void)
+    {
+      if (++_col > _xe) {
+        _col = _xs;
+        if (++_row > _ye) _row = _ys;
+      }
+    }
+
+    void write_pixel(void)
+    {
+      ++_panel_stats.pixels_written;
+      auto p = pixel_address();
+      if (p) {
+        if (_pixel_bytes == 2) { // RGB565 : 5bit colours are expanded by the msb.
+          std::uint32_t r = _args[0] >> 3;
+          std::uint32_t g = (_args[0] << 3 | _args[1] >> 5) & 0x3F;
+          std::uint32_t b = _args[1] & 0x1F;
+          p[0] = r << 1 | r >> 4;
+          p[1] = g;
+          p[2] = b << 1 | b >> 4;
+        } else {
+          p[0] = _args[0] >> 2;
+          p[1] = _args[1] >> 2;
+          p[2] = _args[2] >> 2;
+        }
+      }
+      next_address();
+    }
+
+    // bit stream of the read command : dummy bits, then the data.
+    std::uint32_t read_bit(void)
+    {
+      std::uint32_t dummy = (_cmd == cmd_rddid) ? _rddid_dummy : _read_dummy;
+      if (_rd_bit < dummy) { ++_rd_bit; return 0; }
+      std::uint32_t k = _rd_bit++ - dummy;
+      if (0 == (k & 7)) _rd_byte = read_byte_of(k >> 3);
+      return (_rd_byte >> (7 - (k & 7))) & 1;
+    }
+
+    std::uint8_t read_byte_of(std::uint32_t index)
+    {
+      if (_cmd == cmd_rddid) return (index < 4) ? _id >> (index << 3) : 0;
+      if (_cmd != cmd_ramrd) return 0;
+      std::uint32_t ch = index % 3;  // RGB666, 3 bytes a pixel
+      if (ch == 0) {
+        ++_panel_stats.pixels_read;
+        auto p = pixel_address();
+        if (p) memcpy(_rd_pixel, p, 3);
+        else memset(_rd_pixel, 0, 3);
+        next_address();
+      }
+      return _rd_pixel[ch] << 2;
+    }
+
+    std::uint8_t* _mem = nullptr;
+    std::int32_t _mem_width = 0;
+    std::int32_t _mem_height = 0;
+    std::int32_t _panel_width = 0;
+    std::int32_t _panel_height = 0;
+    std::int32_t _offset_x = 0;
+    std::int32_t _offset_y = 0;
+    bool _panel_bgr = true;
+    bool _panel_invert = false;
+    std::uint32_t _read_dummy = 8;
+    std::uint32_t _rddid_dummy = 1;
+    std::uint32_t _id = 0;
+
+    std::uint8_t _cmd = 0;
+    std::uint8_t _args[8];
+    std::uint32_t _argc = 0;
+    std::uint8_t _madctl = 0;
+    std::uint8_t _pixel_bytes = 2;
+    bool _invon = false;
+    std::int32_t _xs = 0, _xe = 0, _ys = 0, _ye = 0;
+    std::int32_t _col = 0, _row = 0;
+    std::int32_t _tfa = 0, _vsa = 0, _bfa = 0, _vsp = 0;
+    std::uint32_t _rd_bit = 0;
+    std::uint8_t _rd_byte = 0;
+    std::uint8_t _rd_pixel[3];
+
+    panel_stats_t _panel_stats;
+  };
+
+//----------------------------------------------------------------------------
+}
+
+typedef lgfx::Bus_VirtualPanel Bus_VirtualPanel;
+
+#endif
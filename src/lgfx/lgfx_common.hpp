@@ -130,6 +130,30 @@ namespace lgfx
   }
   using namespace attribute;
 
+  namespace fill_rule
+  {
+    enum fill_rule_t : std::uint8_t
+    { even_odd = 0
+    , non_zero = 1
+    };
+  }
+  using namespace fill_rule;
+
+  namespace stroke_style
+  {
+    enum line_cap_t : std::uint8_t
+    { cap_butt   = 0
+    , cap_round  = 1
+    , cap_square = 2
+    };
+    enum line_join_t : std::uint8_t
+    { join_miter = 0  // falls back to bevel beyond a miter limit of 4
+    , join_round = 1
+    , join_bevel = 2
+    };
+  }
+  using namespace stroke_style;
+
   enum color_depth_t : std::uint8_t
   { palette_1bit   =  1 //   2 color
   , palette_2bit   =  2 //   4 color
@@ -742,9 +766,86 @@ namespace lgfx
 
 
 
+//----------------------------------------------------------------------------
+  struct point_t { std::int32_t x, y; };
+  struct rect_t  { std::int32_t x, y, w, h; };
+
+  // gradient paints. colours are rgb888 ( color888() ).
+  struct linear_gradient_t { std::int32_t x0, y0, x1, y1; std::uint32_t color0, color1; }; // color0 at (x0,y0), color1 at (x1,y1), clamped beyond
+  struct radial_gradient_t { std::int32_t x, y, r;        std::uint32_t color0, color1; }; // color0 at the centre, color1 at the radius and beyond
+
+  // display list command, recorded by LGFX_DisplayList. the payload follows the header.
+  struct display_command_t
+  {
+    enum op_t : std::uint8_t
+    { op_fill    // the bounding box. rgb888 when the colour changes, else no payload
+    , op_alpha   // coverage blended with the colour : rgb888, then alpha rows padded to 4 bytes (0 : untouched)
+    , op_pixels  // bgr888 rows, padded to 4 bytes
+    , op_image   // pixelcopy_t referencing the source pixels
+    , op_copy    // copyRect to the bounding box : source x, y
+    };
+
+    std::uint32_t head;        // op | (words << 8). words : length including this header.
+    std::int16_t l, t, r, b;   // bounding box, inclusive
+
+    op_t op(void) const { return (op_t)(head & 0xFF); }
+    std::uint32_t words(void) const { return head >> 8; }
+    const void* data(void) const { return this + 1; }
+    const display_command_t* next(void) const { return (const display_command_t*)((const std::uint32_t*)this + words()); }
+  };
+
 //----------------------------------------------------------------------------
   static constexpr std::uint32_t FP_SCALE = 16;
 
+  // fill with a repeated 1-4 byte color. writes aligned 32bit words,
+  // 24bit colors use the 12 byte (3 word) period.
+  static inline void memset_multi(std::uint8_t* buf, std::uint32_t c, size_t size, size_t length)
+  {
+    size_t len = length * size;
+    std::uint8_t pat[16];
+    for (size_t i = 0; i < 16; ++i) pat[i] = c >> ((i % size) << 3);
+    if (size == 1 || 0 == memcmp(pat, &pat[1], size - 1)) {
+      memset(buf, pat[0], len);
+      return;
+    }
+    size_t i = 0;
+    while (((std::uintptr_t)&buf[i] & 3) && i < len) { buf[i] = pat[i]; ++i; }
+    size_t words = (len - i) >> 2;
+    if (words) {
+      std::uint32_t w[3];
+      memcpy(w, &pat[i], sizeof(w));
+      auto d = (std::uint32_t*)&buf[i];
+      i += words << 2;
+      if (size == 3) {
+        for (; words >= 3; words -= 3) { d[0] = w[0]; d[1] = w[1]; d[2] = w[2]; d += 3; }
+        if (words) { d[0] = w[0]; if (words > 1) d[1] = w[1]; }
+      } else {
+        auto v = w[0];
+        for (; words >= 4; words -= 4) { d[0] = v; d[1] = v; d[2] = v; d[3] = v; d += 4; }
+        while (words--) *d++ = v;
+      }
+    }
+    for (; i < len; ++i) buf[i] = pat[i % size];
+  }
+
+  // 1 bit bitmap to raw colours of 1-3 bytes, 4 pixels per nibble. used as pixelcopy_t::palette.
+  struct bitmap_expand_t
+  {
+    std::uint8_t table[16][12];  // nibble : 4 pixels
+    bool lsb_first;              // xbm bit order
+
+    void init(std::uint32_t fg_raw, std::uint32_t bg_raw, std::uint32_t bytes, bool lsb)
+    {
+      lsb_first = lsb;
+      for (std::uint32_t n = 0; n < 16; ++n) {
+        for (std::uint32_t k = 0; k < 4; ++k) {
+          bool fg = (n >> (lsb ? k : 3 - k)) & 1;
+          memcpy(&table[n][k * bytes], fg ? &fg_raw : &bg_raw, bytes);
+        }
+      }
+    }
+  };
+
   struct pixelcopy_t {
     union {
       std::uint32_t src_x32 = 0;
@@ -764,6 +865,7 @@ namespace lgfx
     std::uint32_t src_x32_add = 1 << FP_SCALE;
     std::uint32_t src_y32_add = 0;
     std::uint32_t src_width = 0;
+    std::uint32_t src_stride = 0; // bytes per source row
     std::uint32_t transp   = ~0;
     std::uint32_t src_bits = 8;
     std::uint32_t dst_bits = 8;
@@ -902,14 +1004,14 @@ namespace lgfx
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       auto src_bits    = param->src_bits;
       auto dst_bits    = param->dst_bits;
       auto src_mask    = param->src_mask;
       auto dst_mask    = param->dst_mask;
       do {
-        std::uint32_t i = ((src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width) * src_bits;
+        std::uint32_t i = (src_x32 >> FP_SCALE) * src_bits + ((src_y32 >> FP_SCALE) * src_stride << 3);
         src_x32 += src_x32_add;
         src_y32 += src_y32_add;
         std::uint32_t raw = (s[i >> 3] >> (-(i + src_bits) & 7)) & src_mask;
@@ -934,13 +1036,13 @@ namespace lgfx
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       auto src_bits    = param->src_bits;
       auto src_mask    = param->src_mask;
       auto pal  = (const TPalette*)param->palette;
       do {
-        std::uint32_t i = ((src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width) * src_bits;
+        std::uint32_t i = (src_x32 >> FP_SCALE) * src_bits + ((src_y32 >> FP_SCALE) * src_stride << 3);
         std::uint32_t raw = (s[i >> 3] >> (-(i + src_bits) & 7)) & src_mask;
         if (raw == transp) break;
         d[index] = pal[raw];
@@ -955,18 +1057,18 @@ namespace lgfx
     template <typename TDst, typename TSrc>
     static std::int32_t normalcopy(void* dst, std::int32_t index, std::int32_t last, pixelcopy_t* param)
     {
-      auto s = (const TSrc*)param->src_data;
+      auto s = (const std::uint8_t*)param->src_data;
       auto d = (TDst*)dst;
       auto src_x32     = param->src_x32;
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       do {
-        std::uint32_t i = (src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width;
-        if (s[i] == transp) break;
-        d[index] = s[i];
+        auto src = (const TSrc*)&s[(src_x32 >> FP_SCALE) * sizeof(TSrc) + (src_y32 >> FP_SCALE) * src_stride];
+        if (*src == transp) break;
+        d[index] = *src;
         src_x32 += src_x32_add;
         src_y32 += src_y32_add;
       } while (++index != last);
@@ -991,12 +1093,12 @@ namespace lgfx
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       auto src_bits    = param->src_bits;
       auto src_mask    = param->src_mask;
       do {
-        std::uint32_t i = ((src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width) * src_bits;
+        std::uint32_t i = (src_x32 >> FP_SCALE) * src_bits + ((src_y32 >> FP_SCALE) * src_stride << 3);
         std::uint32_t raw = (s[i >> 3] >> (-(i + src_bits) & 7)) & src_mask;
         if (raw != transp) break;
         src_x32 += src_x32_add;
@@ -1010,16 +1112,16 @@ namespace lgfx
     template <typename TSrc>
     static std::int32_t normalskip(std::int32_t index, std::int32_t last, pixelcopy_t* param)
     {
-      auto s = (const TSrc*)param->src_data;
+      auto s = (const std::uint8_t*)param->src_data;
       auto src_x32     = param->src_x32;
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       do {
-        std::uint32_t i = (src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width;
-        if (!(s[i] == transp)) break;
+        auto src = (const TSrc*)&s[(src_x32 >> FP_SCALE) * sizeof(TSrc) + (src_y32 >> FP_SCALE) * src_stride];
+        if (!(*src == transp)) break;
         src_x32 += src_x32_add;
         src_y32 += src_y32_add;
       } while (++index != last);
@@ -1028,22 +1130,70 @@ namespace lgfx
       return index;
     }
 
+    // palette : bitmap_expand_t. transp 0 : the background ends the copy, ~0 : opaque.
+    template <std::size_t N>
+    static std::int32_t bitmapcopy(void* dst, std::int32_t index, std::int32_t last, pixelcopy_t* param)
+    {
+      auto e = (const bitmap_expand_t*)param->palette;
+      auto s = &((const std::uint8_t*)param->src_data)[param->src_y * param->src_stride];
+      auto d = (std::uint8_t*)dst;
+      bool opaque = param->transp == ~0u;
+      std::uint32_t x = param->src_x;
+      while (index != last) {
+        std::uint32_t nib = (s[x >> 3] >> (e->lsb_first ? (x & 4) : (~x & 4))) & 15;
+        std::uint32_t k = x & 3;
+        if (!k && last - index >= 4 && (opaque || nib == 15)) {
+          memcpy(&d[index * N], e->table[nib], N * 4);
+          index += 4;
+          x += 4;
+          continue;
+        }
+        bool fg = (nib >> (e->lsb_first ? k : 3 - k)) & 1;
+        if (!fg && !opaque) break;
+        memcpy(&d[index * N], e->table[fg ? 15 : 0], N);
+        ++index;
+        ++x;
+      }
+      param->src_x32 = x << FP_SCALE;
+      return index;
+    }
+
+    static std::int32_t bitmapskip(std::int32_t index, std::int32_t last, pixelcopy_t* param)
+    {
+      auto e = (const bitmap_expand_t*)param->palette;
+      auto s = &((const std::uint8_t*)param->src_data)[param->src_y * param->src_stride];
+      std::uint32_t x = param->src_x;
+      while (index != last) {
+        std::uint32_t b = s[x >> 3];
+        if (!(x & 7) && !b && last - index >= 8) {
+          index += 8;
+          x += 8;
+          continue;
+        }
+        if ((b >> (e->lsb_first ? (x & 7) : (~x & 7))) & 1) break;
+        ++index;
+        ++x;
+      }
+      param->src_x32 = x << FP_SCALE;
+      return index;
+    }
+
     template <typename TSrc>
     static std::int32_t normalcompare(void* dst, std::int32_t index, std::int32_t last, pixelcopy_t* param)
     {
-      auto s = (const TSrc*)param->src_data;
+      auto s = (const std::uint8_t*)param->src_data;
       auto d = (bool*)dst;
       auto src_x32     = param->src_x32;
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       do {
-        std::uint32_t i = (src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width;
+        auto src = (const TSrc*)&s[(src_x32 >> FP_SCALE) * sizeof(TSrc) + (src_y32 >> FP_SCALE) * src_stride];
         src_x32 += src_x32_add;
         src_y32 += src_y32_add;
-        d[index] = s[i] == transp;
+        d[index] = *src == transp;
       } while (++index != last);
       param->src_x32 = src_x32;
       param->src_y32 = src_y32;
@@ -1058,12 +1208,12 @@ namespace lgfx
       auto src_y32     = param->src_y32;
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-      auto src_width   = param->src_width;
+      auto src_stride  = param->src_stride;
       auto transp      = param->transp;
       auto src_bits    = param->src_bits;
       auto src_mask    = param->src_mask;
       do {
-        std::uint32_t i = ((src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_width) * src_bits;
+        std::uint32_t i = (src_x32 >> FP_SCALE) * src_bits + ((src_y32 >> FP_SCALE) * src_stride << 3);
         src_x32 += src_x32_add;
         src_y32 += src_y32_add;
         d[index] = transp == ((s[i >> 3] >> (-(i + src_bits) & 7)) & src_mask);
@@ -1144,8 +1294,34 @@ typedef lgfx::bgr888_t RGBColor;
 
   #include "platforms/samd51_common.hpp"
 
+#elif defined (LGFX_HOST) || defined (__linux__) || defined (__APPLE__) || defined (_WIN32)
+
+  #include "platforms/host_common.hpp"
+
 #endif
 
+namespace lgfx
+{
+  // grows buf (cap elements) to hold need elements. the capacity doubles from first.
+  // on failure buf is kept as it was.
+  template <typename T>
+  static inline bool heap_reserve(T*& buf, std::uint32_t& cap, std::uint32_t need, std::uint32_t first = 16)
+  {
+    if (need <= cap) return true;
+    std::uint32_t n = cap ? cap << 1 : first;
+    while (n < need) n <<= 1;
+    auto p = (T*)heap_alloc(n * sizeof(T));
+    if (!p) return false;
+    if (buf) {
+      memcpy(p, buf, cap * sizeof(T));
+      heap_free(buf);
+    }
+    buf = p;
+    cap = n;
+    return true;
+  }
+}
+
 
 
 #endif
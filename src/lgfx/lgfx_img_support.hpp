@@ -72,7 +72,7 @@ namespace lgfx
 
  #endif
 
-#elif defined (CONFIG_IDF_TARGET_ESP32)  || defined(__SAMD51_HARMONY__) // ESP-IDF or Harmony
+#elif defined (CONFIG_IDF_TARGET_ESP32)  || defined(__SAMD51_HARMONY__) || defined (LGFX_HOST) // ESP-IDF, Harmony or host
 
     inline void drawBmpFile(const char *path, std::int32_t x, std::int32_t y) {
       FileWrapper file;
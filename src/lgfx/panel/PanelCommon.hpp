@@ -8,6 +8,35 @@ namespace lgfx
 {
   static constexpr std::uint8_t CMD_INIT_DELAY = 0x80;
 
+  // rows of the hardware scroll zone as stored in the panel memory.
+  struct vscroll_rows_t
+  {
+    std::int32_t top    = 0;
+    std::int32_t height = 0;
+    std::int32_t offset = 0;  // 0 : rows are not rotated
+
+    // memory row of row y.
+    std::int32_t row(std::int32_t y) const
+    {
+      std::int32_t i = y - top;
+      if (!offset || i < 0 || i >= height) return y;
+      i += offset;
+      return top + (i < height ? i : i - height);
+    }
+
+    // rows from y (up to h) stored contiguously.
+    std::int32_t run(std::int32_t y, std::int32_t h) const
+    {
+      if (!offset) return h;
+      std::int32_t i = y - top;
+      std::int32_t n = (i < 0)                ? -i                      // up to the zone
+                     : (i >= height)          ? h                       // below the zone
+                     : (i < height - offset)  ? height - offset - i     // up to the wrap
+                                              : height - i;             // up to the zone end
+      return n < h ? n : h;
+    }
+  };
+
   struct PanelCommon
   {
     std::uint32_t freq_write = 2700000;    // SPI freq (write pixel)
@@ -114,6 +143,10 @@ namespace lgfx
 
     virtual const std::uint8_t* getRotationCommands(std::uint8_t* buf, std::int_fast8_t r) = 0;
 
+    // hardware vertical scroll : rows [top, top+height) are shown from memory row top+offset. (rows of the current rotation)
+    // nullptr : not supported, or the rotation does not keep the memory rows.
+    virtual const std::uint8_t* getVScrollCommands(std::uint8_t*, std::int_fast16_t /*top*/, std::int_fast16_t /*height*/, std::int_fast16_t /*offset*/) { return nullptr; }
+
     std::uint8_t getCmdCaset(void) const { return cmd_caset; }
     std::uint8_t getCmdRaset(void) const { return cmd_raset; }
     std::uint8_t getCmdRamwr(void) const { return cmd_ramwr; }
@@ -43,6 +43,29 @@ namespace lgfx
       return buf;
     }
 
+    const std::uint8_t* getVScrollCommands(std::uint8_t* buf, std::int_fast16_t top, std::int_fast16_t height, std::int_fast16_t offset) override
+    {
+      if (getMadCtl(rotation) & (MAD_MV | MAD_MY)) return nullptr;
+      std::int_fast16_t tfa = getRowStart() + top;
+      std::int_fast16_t bfa = memory_height - tfa - height;
+      if (tfa < 0 || height < 1 || bfa < 0) return nullptr;
+      std::int_fast16_t vsp = tfa + offset;
+      buf[ 0] = CommandCommon::VSCRDEF;
+      buf[ 1] = 6;
+      buf[ 2] = tfa >> 8;
+      buf[ 3] = tfa;
+      buf[ 4] = height >> 8;
+      buf[ 5] = height;
+      buf[ 6] = bfa >> 8;
+      buf[ 7] = bfa;
+      buf[ 8] = CommandCommon::VSCRSADD;
+      buf[ 9] = 2;
+      buf[10] = vsp >> 8;
+      buf[11] = vsp;
+      buf[12] = buf[13] = 0xFF;
+      return buf;
+    }
+
     virtual std::uint8_t getMadCtl(std::uint8_t r) const {
       static constexpr std::uint8_t madctl_table[] = {
                                          0,
@@ -98,7 +121,9 @@ namespace lgfx
     static constexpr std::uint8_t RASET   = 0x2B; static constexpr std::uint8_t PASET = 0x2B;
     static constexpr std::uint8_t RAMWR   = 0x2C;
     static constexpr std::uint8_t RAMRD   = 0x2E;
+    static constexpr std::uint8_t VSCRDEF = 0x33;
     static constexpr std::uint8_t MADCTL  = 0x36;
+    static constexpr std::uint8_t VSCRSADD= 0x37;
     static constexpr std::uint8_t COLMOD  = 0x3A; static constexpr std::uint8_t PIXSET = 0x3A;
     };
 
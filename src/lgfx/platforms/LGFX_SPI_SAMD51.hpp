@@ -21,7 +21,7 @@ Contributors:
 #define LGFX_SPI_SAMD51_HPP_
 
 #include "samd51_common.hpp"
-#include "../LGFXBase.hpp"
+#include "../LGFX_PanelProtocol.hpp"
 
 #if defined (ARDUINO)
 #include <SERCOM.h>
@@ -201,8 +201,10 @@ namespace lgfx
 
 
   template <class CFG>
-  class LGFX_SPI : public LovyanGFX
+  class LGFX_SPI : public LGFX_PanelProtocol<LGFX_SPI<CFG> >
   {
+    typedef LGFX_PanelProtocol<LGFX_SPI<CFG> > base_t;
+    friend base_t;
 
   public:
 
@@ -215,79 +217,13 @@ namespace lgfx
       //  _dmadesc = nullptr;
       //  _dmadesc_len = 0;
       //}
-      delete_dmabuffer();
     }
 
-    LGFX_SPI() : LovyanGFX()
+    LGFX_SPI() : base_t()
     {
-      _panel = nullptr;
-
       _sercom = reinterpret_cast<Sercom*>(sercomData[CFG::sercom_index].sercomPtr);
     }
 
-    void setPanel(PanelCommon* panel) { _panel = panel; postSetPanel(); }
-
-    __attribute__ ((always_inline)) inline PanelCommon* getPanel(void) const { return _panel; }
-
-    __attribute__ ((always_inline)) inline bool getInvert(void) const { return _panel->invert; }
-
-    __attribute__ ((always_inline)) inline void dmaWait(void) const { wait_spi(); }
-
-    __attribute__ ((always_inline)) inline void begin(void) { init(); }
-
-    void init(void) { initBus(); initPanel(); }
-
-    // Write single byte as COMMAND
-    void writeCommand(std::uint_fast8_t cmd) { startWrite(); write_cmd(cmd); endWrite(); } // AdafruitGFX compatible
-    void writecommand(std::uint_fast8_t cmd) { startWrite(); write_cmd(cmd); endWrite(); } // TFT_eSPI compatible
-
-    // Write single bytes as DATA
-    void spiWrite( std::uint_fast8_t data) { startWrite(); if (_spi_dlen == 16) { write_data(data << 8, _spi_dlen); } else { write_data(data, _spi_dlen); } endWrite(); } // AdafruitGFX compatible
-    void writeData(std::uint_fast8_t data) { startWrite(); if (_spi_dlen == 16) { write_data(data << 8, _spi_dlen); } else { write_data(data, _spi_dlen); } endWrite(); } // TFT_eSPI compatible
-    void writedata(std::uint_fast8_t data) { startWrite(); if (_spi_dlen == 16) { write_data(data << 8, _spi_dlen); } else { write_data(data, _spi_dlen); } endWrite(); } // TFT_eSPI compatible
-
-    // Read data
-    std::uint8_t  readCommand8( std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return read_command(commandByte, index << 3, 8); }
-    std::uint8_t  readcommand8( std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return read_command(commandByte, index << 3, 8); }
-    std::uint16_t readCommand16(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap16(read_command(commandByte, index << 3, 16)); }
-    std::uint16_t readcommand16(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap16(read_command(commandByte, index << 3, 16)); }
-    std::uint32_t readCommand32(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap32(read_command(commandByte, index << 3, 32)); }
-    std::uint32_t readcommand32(std::uint_fast8_t commandByte, std::uint_fast8_t index=0) { return __builtin_bswap32(read_command(commandByte, index << 3, 32)); }
-
-    void setColorDepth(std::uint8_t bpp) { setColorDepth((color_depth_t)bpp); }
-
-    void sleep()  { writeCommand(_panel->getCmdSlpin()); }
-
-    void wakeup() { writeCommand(_panel->getCmdSlpout()); }
-
-    void setColorDepth(color_depth_t depth)
-    {
-      std::uint8_t buf[32];
-      commandList(_panel->getColorDepthCommands(buf, depth));
-      postSetColorDepth();
-    }
-
-    void setRotation(std::int_fast8_t r)
-    {
-      std::uint8_t buf[32];
-      commandList(_panel->getRotationCommands(buf, r));
-      postSetRotation();
-    }
-
-    void invertDisplay(bool i)
-    {
-      std::uint8_t buf[32];
-      commandList(_panel->getInvertDisplayCommands(buf, i));
-    }
-
-    void setBrightness(std::uint8_t brightness) {
-      _panel->setBrightness(brightness);
-    }
-
-    std::uint32_t readPanelID(void)
-    {
-      return read_command(_panel->getCmdRddid(), _panel->len_dummy_read_rddid, 32);
-    }
 
 
 std::uint32_t freqRef; // Frequency corresponding to clockSource
@@ -518,53 +454,22 @@ void disableSPI()
 //*/
     }
 
-    virtual void initPanel(void)
-    {
-      if (!_panel) return;
-
-      _panel->init();
-
-      startWrite();
-
-      const std::uint8_t *cmds;
-      for (std::uint8_t i = 0; (cmds = _panel->getInitCommands(i)); i++) {
-        delay(120);
-        cs_l();
-        commandList(cmds);
-        wait_spi();
-        cs_h();
-      }
-      cs_l();
-
-      invertDisplay(getInvert());
-      setColorDepth(getColorDepth());
-      setRotation(getRotation());
-      clear();
-
-      endWrite();
-
-      _sx = _sy = 0;
-      _sw = _width;
-      _sh = _height;
-    }
-
-    void pushPixelsDMA(const void* data, std::uint32_t length) {
-      write_bytes((const std::uint8_t*)data, length, true);
-    }
-
 
 //----------------------------------------------------------------------------
   protected:
 
-    bool isReadable_impl(void) const override { return _panel->spi_read; }
-    std::int_fast8_t getRotation_impl(void) const override { return _panel->rotation; }
+    // names of the dependent base class.
+    using base_t::_panel;
+    using base_t::_len_setwindow;
+    using base_t::_color;
+    using base_t::_write_conv;
+    using base_t::_read_conv;
+    using base_t::cs_h;
+    using base_t::cs_l;
 
     void postSetPanel(void)
     {
       _last_apb_freq = -1;
-      _cmd_ramwr      = _panel->getCmdRamwr();
-      _len_setwindow  = _panel->len_setwindow;
-      fpGetWindowAddr = _len_setwindow == 32 ? PanelCommon::getWindowAddr32 : PanelCommon::getWindowAddr16;
 
       std::int32_t spi_dc = _panel->spi_dc;
       _mask_reg_dc = (1ul << (spi_dc & 0xFF));
@@ -574,44 +479,7 @@ void disableSPI()
       dc_h();
       lgfxPinMode(spi_dc, pin_mode_t::output);
 
-      cs_h();
-      lgfxPinMode(_panel->spi_cs, pin_mode_t::output);
-
-      postSetRotation();
-      postSetColorDepth();
-    }
-
-    void postSetRotation(void)
-    {
-      bool fullscroll = (_sx == 0 && _sy == 0 && _sw == _width && _sh == _height);
-
-      _cmd_caset = _panel->getCmdCaset();
-      _cmd_raset = _panel->getCmdRaset();
-      _colstart  = _panel->getColStart();
-      _rowstart  = _panel->getRowStart();
-      _width     = _panel->getWidth();
-      _height    = _panel->getHeight();
-      _clip_r = _width - 1;
-      _clip_b = _height - 1;
-
-      if (fullscroll) {
-        _sw = _width;
-        _sh = _height;
-      }
-      _xs = _xe = _ys = _ye = ~0;
-      _clip_l = _clip_t = 0;
-    }
-
-    void postSetColorDepth(void)
-    {
-      _write_conv.setColorDepth(_panel->write_depth);
-      _read_conv.setColorDepth(_panel->read_depth);
-    }
-
-    void beginTransaction_impl(void) override {
-      if (_begun_tr) return;
-      _begun_tr = true;
-      begin_transaction();
+      base_t::postSetPanel();
     }
 
     void begin_transaction(void) {
@@ -621,12 +489,6 @@ void disableSPI()
       cs_l();
     }
 
-    void endTransaction_impl(void) override {
-      if (!_begun_tr) return;
-      _begun_tr = false;
-      end_transaction();
-    }
-
     void end_transaction(void) {
       wait_spi();
       if (_panel->spi_cs < 0) {
@@ -636,59 +498,13 @@ void disableSPI()
       cs_h();
     }
 
-    void waitDMA_impl(void) override
-    {
-      wait_spi();
-    }
-
-    void setWindow_impl(std::int32_t xs, std::int32_t ys, std::int32_t xe, std::int32_t ye) override
-    {
-      if (_fill_mode) {
-        _fill_mode = false;
-        wait_spi();
-        set_clock_write();
-      }
-      set_window(xs, ys, xe, ye);
-      write_cmd(_cmd_ramwr);
-    }
-
-    void drawPixel_impl(std::int32_t x, std::int32_t y) override
-    {
-      if (_begun_tr) {
-        if (_fill_mode) {
-          _fill_mode = false;
-          wait_spi();
-          set_clock_write();
-        }
-        set_window(x, y, x, y);
-        write_cmd(_cmd_ramwr);
-        write_data(_color.raw, _write_conv.bits);
-        return;
-      }
-
-      begin_transaction();
-      set_window(x, y, x, y);
-      write_cmd(_cmd_ramwr);
-      write_data(_color.raw, _write_conv.bits);
-      end_transaction();
-    }
-
-    void writeFillRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) override
+    void end_fill(void)
     {
       if (_fill_mode) {
         _fill_mode = false;
         wait_spi();
         set_clock_write();
       }
-      set_window(x, y, x+w-1, y+h-1);
-      write_cmd(_cmd_ramwr);
-
-      push_block(w*h, _clkdiv_write != _clkdiv_fill);
-    }
-
-    void pushBlock_impl(std::int32_t length) override
-    {
-      push_block(length);
     }
 
     void push_block(std::int32_t length, bool fillclock = false)
@@ -708,7 +524,7 @@ void disableSPI()
         length >>= 1;
         bytes = 4;
       }
-      if (fillclock && 2 <= length) { _fill_mode = true; dc_h(); set_clock_fill(); }
+      if (fillclock && _clkdiv_write != _clkdiv_fill && 2 <= length) { _fill_mode = true; dc_h(); set_clock_fill(); }
       else { dc_h(); }
       _sercom->SPI.LENGTH.reg = bytes | SERCOM_SPI_LENGTH_LENEN;
       *reg = data;
@@ -719,37 +535,6 @@ void disableSPI()
       };
     }
 
-    bool commandList(const std::uint8_t *addr)
-    {
-      if (addr == nullptr) return false;
-      std::uint8_t  cmd;
-      std::uint8_t  numArgs;
-      std::uint8_t  ms;
-
-      _fill_mode = false;
-      wait_spi();
-      startWrite();
-      set_clock_write();
-      for (;;) {                // For each command...
-        cmd     = *addr++;  // Read, issue command
-        numArgs = *addr++;  // Number of args to follow
-        if (0xFF == (cmd & numArgs)) break;
-        write_cmd(cmd);
-        ms = numArgs & CMD_INIT_DELAY;       // If hibit set, delay follows args
-        numArgs &= ~CMD_INIT_DELAY;          // Mask out delay bit
-
-        while (numArgs--) {                   // For each argument...
-          writeData(*addr++);  // Read, issue argument
-        }
-        if (ms) {
-          ms = *addr++;        // Read post-command delay time (ms)
-          delay( (ms==255 ? 500 : ms) );
-        }
-      }
-      endWrite();
-      return true;
-    }
-
     void write_cmd(std::uint_fast8_t cmd)
     {
       if (_spi_dlen == 16) { cmd <<= 8; }
@@ -777,46 +562,17 @@ void disableSPI()
       _need_wait = true;
     }
 
-    void set_window(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
+    void write_param(std::uint_fast8_t data)
     {
-      std::uint32_t len;
-      if (_spi_dlen == 8) {
-        len = _len_setwindow;
-      } else {
-        len = (_len_setwindow << 1);
-      }
-      auto fp = fpGetWindowAddr;
-
-      if (_xs != xs || _xe != xe) {
-        write_cmd(_cmd_caset);
-        _xs = xs;
-        _xe = xe;
-        std::uint32_t tmp = _colstart;
-
-        tmp = fp(xs + tmp, xe + tmp);
-        if (_spi_dlen == 8) {
-          write_data(tmp, len);
-        } else if (_spi_dlen == 16) {
-          write_data((tmp & 0xFF) << 8 | (tmp >> 8) << 24, 32);
-          tmp >>= 16;
-          write_data((tmp & 0xFF) << 8 | (tmp >> 8) << 24, 32);
-        }
-      }
-      if (_ys != ys || _ye != ye) {
-        write_cmd(_cmd_raset);
-        _ys = ys;
-        _ye = ye;
-        std::uint32_t tmp = _rowstart;
-
-        tmp = fp(ys + tmp, ye + tmp);
-        if (_spi_dlen == 8) {
-          write_data(tmp, len);
-        } else if (_spi_dlen == 16) {
-          write_data((tmp & 0xFF) << 8 | (tmp >> 8) << 24, 32);
-          tmp >>= 16;
-          write_data((tmp & 0xFF) << 8 | (tmp >> 8) << 24, 32);
-        }
-      }
+      if (_spi_dlen == 16) { write_data(data << 8, _spi_dlen); } else { write_data(data, _spi_dlen); }
+    }
+
+    void write_addr(std::uint32_t addr)
+    {
+      if (_spi_dlen == 8) { write_data(addr, _len_setwindow); return; }
+      write_data((addr & 0xFF) << 8 | (addr >> 8) << 24, 32);
+      addr >>= 16;
+      write_data((addr & 0xFF) << 8 | (addr >> 8) << 24, 32);
     }
 
     void start_read(void) {
@@ -839,93 +595,16 @@ void disableSPI()
       cs_l();
     }
 
-    std::uint32_t read_data(std::uint32_t length)
+    std::uint32_t read_data(std::uint32_t bitlen)
     {
       dc_h();
-      write_data(0, length);
+      write_data(0, bitlen);
       return _sercom->SPI.DATA.reg;
     }
 
-    std::uint32_t read_command(std::uint_fast8_t command, std::uint32_t bitindex = 0, std::uint32_t bitlen = 8)
+    void read_dummy(std::uint32_t bitlen)
     {
-      startWrite();
-      write_cmd(command);
-      start_read();
-      if (bitindex) read_data(bitindex>>3);
-      std::uint32_t res = read_data(bitlen>>3);
-      end_read();
-      endWrite();
-      return res;
-    }
-
-    void pushImage_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, pixelcopy_t* param, bool use_dma) override
-    {
-      auto bytes = _write_conv.bytes;
-      auto src_x = param->src_x;
-      auto fp_copy = param->fp_copy;
-
-      std::int32_t xr = (x + w) - 1;
-
-      if (param->transp == ~0u) {
-        if (param->no_convert) {
-          setWindow_impl(x, y, xr, y + h - 1);
-          std::uint32_t i = (src_x + param->src_y * param->src_width) * bytes;
-          auto src = &((const std::uint8_t*)param->src_data)[i];
-
-          if ((std::int32_t)param->src_width == w || h == 1) {
-            std::int32_t len = w * h * bytes;
-            write_bytes(src, len, use_dma);
-          } else {
-            auto add = param->src_width * bytes;
-            do {
-              write_bytes(src, w * bytes, use_dma);
-              src += add;
-            } while (--h);
-          }
-        } else
-        if (use_dma)
-        {
-          auto buf = get_dmabuffer(w * bytes);
-          fp_copy(buf, 0, w, param);
-          setWindow_impl(x, y, xr, y + h - 1);
-          write_bytes(buf, w * bytes, true);
-          while (--h) {
-            param->src_x = src_x;
-            param->src_y++;
-            buf = get_dmabuffer(w * bytes);
-            fp_copy(buf, 0, w, param);
-            write_bytes(buf, w * bytes, true);
-          }
-        } else {
-          setWindow_impl(x, y, xr, y + h - 1);
-          do {
-            push_colors(w, param);
-            param->src_x = src_x;
-            param->src_y++;
-          } while (--h);
-        }
-      } else {
-        auto fp_skip = param->fp_skip;
-        h += y;
-        do {
-          std::int32_t i = 0;
-          while (w != (i = fp_skip(i, w, param))) {
-            auto buf = get_dmabuffer(w * bytes);
-            std::int32_t len = fp_copy(buf, 0, w - i, param);
-            setWindow_impl(x + i, y, x + i + len - 1, y);
-            write_bytes(buf, len * bytes, true);
-            if (w == (i += len)) break;
-          }
-          param->src_x = src_x;
-          param->src_y++;
-        } while (++y != h);
-      }
-//*/
-    }
-
-    void pushColors_impl(std::int32_t length, pixelcopy_t* param) override
-    {
-      push_colors(length, param);
+      write_data(0, bitlen);
     }
 
     void push_colors(std::int32_t length, pixelcopy_t* param)
@@ -1027,46 +706,6 @@ void disableSPI()
       };
     }
 
-    void readRect_impl(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, void* dst, pixelcopy_t* param) override
-    {
-      set_window(x, y, x + w - 1, y + h - 1);
-      auto len = w * h;
-      if (!_panel->spi_read) {
-        memset(dst, 0, len * _read_conv.bytes);
-        return;
-      }
-      write_cmd(_panel->getCmdRamrd());
-      std::uint32_t len_dummy_read_pixel = _panel->len_dummy_read_pixel;
-      start_read();
-      if (len_dummy_read_pixel) {;
-        write_data(0, len_dummy_read_pixel);
-      }
-
-      if (param->no_convert) {
-        read_bytes((std::uint8_t*)dst, len * _read_conv.bytes);
-      } else {
-        read_pixels(dst, len, param);
-      }
-//*/
-      end_read();
-    }
-
-    void read_pixels(void* dst, std::int32_t length, pixelcopy_t* param)
-    {
-      std::int32_t bytes = _read_conv.bytes;
-      std::int32_t dstindex = 0;
-      std::int32_t len = 4;
-      std::uint8_t buf[24];
-      param->src_data = buf;
-      do {
-        if (len > length) len = length;
-        read_bytes(buf, len * bytes);
-        param->src_x = 0;
-        dstindex = param->fp_copy(dst, dstindex, dstindex + len, param);
-        length -= len;
-      } while (length);
-    }
-
     void read_bytes(std::uint8_t* dst, std::int32_t length)
     {
 /*
@@ -1139,65 +778,6 @@ void disableSPI()
       _need_wait = false;
     }
 
-    void copyRect_impl(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y) override
-    {
-      pixelcopy_t p((void*)nullptr, _write_conv.depth, _read_conv.depth);
-      if (w < h) {
-        const std::uint32_t buflen = h * _write_conv.bytes;
-        auto buf = get_dmabuffer(buflen);
-        std::int32_t add = (src_x < dst_x) ?   - 1 : 1;
-        std::int32_t pos = (src_x < dst_x) ? w - 1 : 0;
-        do {
-          readRect_impl(src_x + pos, src_y, 1, h, buf, &p);
-          setWindow_impl(dst_x + pos, dst_y, dst_x + pos, dst_y + h - 1);
-          write_bytes(buf, buflen, true);
-          pos += add;
-        } while (--w);
-      } else {
-        const std::uint32_t buflen = w * _write_conv.bytes;
-        auto buf = get_dmabuffer(buflen);
-        std::int32_t add = (src_y < dst_y) ?   - 1 : 1;
-        std::int32_t pos = (src_y < dst_y) ? h - 1 : 0;
-        do {
-          readRect_impl(src_x, src_y + pos, w, 1, buf, &p);
-          setWindow_impl(dst_x, dst_y + pos, dst_x + w - 1, dst_y + pos);
-          write_bytes(buf, buflen, true);
-          pos += add;
-        } while (--h);
-      }
-    }
-
-    struct _dmabufs_t {
-      std::uint8_t* buffer = nullptr;
-      std::uint32_t length = 0;
-      void free(void) {
-        if (buffer) {
-          heap_free(buffer);
-          buffer = nullptr;
-          length = 0;
-        }
-      }
-    };
-
-    std::uint8_t* get_dmabuffer(std::uint32_t length)
-    {
-      _dma_flip = !_dma_flip;
-      length = (length + 3) & ~3;
-      if (_dmabufs[_dma_flip].length < length) {
-        _dmabufs[_dma_flip].free();
-        _dmabufs[_dma_flip].buffer = (std::uint8_t*)heap_alloc_dma(length);
-        _dmabufs[_dma_flip].length = _dmabufs[_dma_flip].buffer ? length : 0;
-      }
-      return _dmabufs[_dma_flip].buffer;
-      return nullptr;
-    }
-
-    void delete_dmabuffer(void)
-    {
-      _dmabufs[0].free();
-      _dmabufs[1].free();
-    }
-
     //static void _alloc_dmadesc(size_t len)
     //{
     //  if (_dmadesc) heap_free(_dmadesc);
@@ -1224,37 +804,15 @@ void disableSPI()
       *gpio_reg_dc_l = mask_reg_dc;
     }
 
-    void cs_h(void) {
-      gpio_hi(_panel->spi_cs);
-    }
-    void cs_l(void) {
-      gpio_lo(_panel->spi_cs);
-    }
-
     static constexpr int _spi_mosi = get_spi_mosi<CFG, -1>::value;
     static constexpr int _spi_miso = get_spi_miso<CFG, -1>::value;
     static constexpr int _spi_sclk = get_spi_sclk<CFG, -1>::value;
     static constexpr int _spi_dlen = get_spi_dlen<CFG,  8>::value;
 
-    PanelCommon* _panel = nullptr;
-    std::uint32_t(*fpGetWindowAddr)(std::uint_fast16_t, std::uint_fast16_t);
-    std::uint_fast16_t _colstart;
-    std::uint_fast16_t _rowstart;
-    std::uint_fast16_t _xs;
-    std::uint_fast16_t _xe;
-    std::uint_fast16_t _ys;
-    std::uint_fast16_t _ye;
-    std::uint32_t _cmd_caset;
-    std::uint32_t _cmd_raset;
-    std::uint32_t _cmd_ramwr;
     std::uint32_t _last_apb_freq;
     std::uint32_t _clkdiv_write;
     std::uint32_t _clkdiv_read;
     std::uint32_t _clkdiv_fill;
-    std::uint32_t _len_setwindow;
-    _dmabufs_t _dmabufs[2];
-    bool _begun_tr = false;
-    bool _dma_flip = false;
     bool _fill_mode;
     std::uint32_t _mask_reg_dc;
     volatile std::uint32_t* _gpio_reg_dc_h;
@@ -0,0 +1,95 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+#ifndef LGFX_HOST_COMMON_HPP_
+#define LGFX_HOST_COMMON_HPP_
+
+// platform of the host build (Linux / macOS / Windows). no hardware, no panel bus.
+// use LGFX_Framebuffer, or LGFX_Device with Bus_Memory / Bus_VirtualPanel.
+#ifndef LGFX_HOST
+#define LGFX_HOST
+#endif
+
+#include "../lgfx_common.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// arduino compatible timing.
+static inline std::uint32_t millis(void)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static inline std::uint32_t micros(void)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static inline void delay(std::uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+static inline void delayMicroseconds(std::uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+namespace lgfx
+{
+  static inline void* heap_alloc(      size_t length) { return malloc(length); }
+  static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
+  static inline void* heap_alloc_dma(  size_t length) { return malloc((length + 3) & ~3); }
+  static inline void heap_free(void* buf) { free(buf); }
+
+  enum pin_mode_t
+  { output
+  , input
+  , input_pullup
+  , input_pulldown
+  };
+
+  // no gpio on the host.
+  static inline void lgfxPinMode(std::int_fast8_t, pin_mode_t) {}
+  static inline void gpio_hi(std::int_fast8_t) {}
+  static inline void gpio_lo(std::int_fast8_t) {}
+  static inline bool gpio_in(std::int_fast8_t) { return false; }
+
+  static inline void initPWM(std::int_fast8_t, std::uint32_t, std::uint8_t = 128) {}
+  static inline void setPWMDuty(std::uint32_t, std::uint8_t) {}
+
+//----------------------------------------------------------------------------
+  struct FileWrapper : public DataWrapper {
+    FileWrapper() : DataWrapper() { need_transaction = false; }
+    virtual ~FileWrapper() { close(); }
+
+    FILE* _fp = nullptr;
+    bool open(const char* path, const char* mode) { close(); return (_fp = fopen(path, (mode[0] == 'r' && !mode[1]) ? "rb" : mode)); }
+    int read(std::uint8_t *buf, std::uint32_t len) override { return fread((char*)buf, 1, len, _fp); }
+    void skip(std::int32_t offset) override { seek(offset, SEEK_CUR); }
+    bool seek(std::uint32_t offset) override { return seek(offset, SEEK_SET); }
+    bool seek(std::int32_t offset, int origin) { return 0 == fseek(_fp, offset, origin); }
+    void close() override { if (_fp) { fclose(_fp); _fp = nullptr; } }
+  };
+//----------------------------------------------------------------------------
+  struct StreamWrapper : public DataWrapper {
+    int read(std::uint8_t*, std::uint32_t) override { return 0; }
+    void skip(std::int32_t) override { }
+    bool seek(std::uint32_t) override { return false; }
+    void close() override { }
+  };
+
+//----------------------------------------------------------------------------
+}
+
+#endif
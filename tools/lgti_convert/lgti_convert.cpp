@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX library - ESP32 hardware SPI graphics library .  
+  
+    for Arduino and ESP-IDF  
+  
+Original Source:  
+ https://github.com/lovyan03/LovyanGFX/  
+
+Licence:  
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)  
+
+Author:  
+ [lovyan03](https://twitter.com/lovyan03)  
+
+Contributors:  
+ [ciniml](https://github.com/ciniml)  
+ [mongonta0716](https://github.com/mongonta0716)  
+ [tobozo](https://github.com/tobozo)  
+/----------------------------------------------------------------------------*/
+// LGTI tile file producer for LGFX_TileViewport. (host build)
+//
+// build (Linux / macOS) :
+//   cd tools/lgti_convert
+//   gcc -c -O2 -I../../src/lgfx ../../src/lgfx/utility/*.c
+//   g++ -std=gnu++11 -O2 -I../../src -I../../src/lgfx lgti_convert.cpp ../../src/lgfx/LGFXBase.cpp ../../src/Fonts/lgfx_fonts.cpp *.o -o lgti_convert
+//
+// usage :
+//   lgti_convert <input.bmp|input.png> <output.lgti> [tile_size=64] [depth=16]
+//   depth : 8 (rgb332) / 16 (rgb565) / 24 (rgb888)
+//
+// copy the output to the SD card and open it with LGFX_TileViewport::open().
+
+#include <LovyanGFX.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static bool png_size(const char* path, std::int32_t* w, std::int32_t* h)
+{
+  std::uint8_t hdr[24];
+  FILE* fp = fopen(path, "rb");
+  if (!fp) return false;
+  bool res = (24 == fread(hdr, 1, 24, fp)) && !memcmp(&hdr[1], "PNG", 3) && !memcmp(&hdr[12], "IHDR", 4);
+  fclose(fp);
+  if (!res) return false;
+  *w = hdr[16] << 24 | hdr[17] << 16 | hdr[18] << 8 | hdr[19];
+  *h = hdr[20] << 24 | hdr[21] << 16 | hdr[22] << 8 | hdr[23];
+  return true;
+}
+
+static bool load_image(LGFX_Sprite* img, const char* path)
+{
+  std::int32_t w, h;
+  if (png_size(path, &w, &h)) {
+    img->setColorDepth(lgfx::rgb888_3Byte);
+    if (!img->createSprite(w, h)) return false;
+    return img->drawPngFile(path, 0, 0);
+  }
+  img->createFromBmpFile(path);
+  return img->width() > 0;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <input.bmp|input.png> <output.lgti> [tile_size=64] [depth=16]\n", argv[0]);
+    return 1;
+  }
+  std::int32_t tile_size = (argc > 3) ? atoi(argv[3]) : 64;
+  std::int32_t depth     = (argc > 4) ? atoi(argv[4]) : 16;
+  if (tile_size < 1 || tile_size > 0xFFFF || (depth != 8 && depth != 16 && depth != 24)) {
+    fprintf(stderr, "bad tile_size or depth\n");
+    return 1;
+  }
+
+  LGFX_Sprite img;
+  if (!load_image(&img, argv[1])) {
+    fprintf(stderr, "can not load %s\n", argv[1]);
+    return 1;
+  }
+
+  // one tile, converted by the library to the file pixel format. (rgb565 is stored big endian)
+  LGFX_Sprite tile;
+  tile.setColorDepth((lgfx::color_depth_t)depth);
+  if (!tile.createSprite(tile_size, tile_size)) return 1;
+
+  FILE* fp = fopen(argv[2], "wb");
+  if (!fp) {
+    fprintf(stderr, "can not open %s\n", argv[2]);
+    return 1;
+  }
+  std::uint32_t w = img.width();
+  std::uint32_t h = img.height();
+  std::uint8_t hdr[LGFX_TileViewport::header_size] = { 'L', 'G', 'T', 'I'
+    , (std::uint8_t)w, (std::uint8_t)(w >> 8), (std::uint8_t)(w >> 16), (std::uint8_t)(w >> 24)
+    , (std::uint8_t)h, (std::uint8_t)(h >> 8), (std::uint8_t)(h >> 16), (std::uint8_t)(h >> 24)
+    , (std::uint8_t)tile_size, (std::uint8_t)(tile_size >> 8)
+    , (std::uint8_t)depth, 0 };
+  fwrite(hdr, 1, sizeof(hdr), fp);
+
+  std::uint32_t row = tile_size * depth >> 3;
+  for (std::int32_t ty = 0; ty < (std::int32_t)h; ty += tile_size) {
+    for (std::int32_t tx = 0; tx < (std::int32_t)w; tx += tile_size) {
+      tile.fillScreen(0);
+      img.pushSprite(&tile, -tx, -ty);
+      auto buf = (const std::uint8_t*)tile.getBuffer();
+      for (std::int32_t y = 0; y < tile_size; ++y) {
+        fwrite(&buf[y * tile.bufferStride()], 1, row, fp);
+      }
+    }
+  }
+  bool res = !ferror(fp);
+  fclose(fp);
+  if (!res) {
+    fprintf(stderr, "write error %s\n", argv[2]);
+    return 1;
+  }
+  printf("%s : %u x %u, tile %d, depth %d\n", argv[2], w, h, tile_size, depth);
+  return 0;
+}